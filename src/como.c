@@ -5,10 +5,45 @@
  */
 
 
+/* Peer credentials (struct ucred) for server mode. */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <regex.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <sched.h>
+#include <limits.h>
 #include "como.h"
 
+/* Tracepoints are disabled if SystemTap SDT header is missing. */
+#if defined( COMO_USDT ) && defined( __has_include )
+#if !__has_include( <sys/sdt.h> )
+#warning "sys/sdt.h not found, static tracepoints (COMO_USDT) are disabled"
+#undef COMO_USDT
+#endif
+#endif
+
+#ifdef COMO_USDT
+#include <sys/sdt.h>
+#endif
+
 
 
 /*
@@ -17,12 +52,12 @@
  */
 
 /** abu-version */
-const char* como_version = "0.3.1";
+COMO_API const char* como_version = "0.3.1";
 
-como_cmd_t como_cmd = NULL;
-como_cmd_t como_main = NULL;
-pl_i64_t   como_argc = 0;
-char**     como_argv = NULL;
+COMO_API como_cmd_t como_cmd = NULL;
+COMO_API como_cmd_t como_main = NULL;
+COMO_API pl_i64_t   como_argc = 0;
+COMO_API char**     como_argv = NULL;
 
 
 /* Initial memory resource for allocations. */
@@ -30,21 +65,399 @@ char**     como_argv = NULL;
 static char   como_init_mem[ COMO_INIT_MEM_SIZE ];
 static plam_s como_mem;
 
+/** Memory for option values (per request in server mode). */
+static __thread plam_t value_mem = &como_mem;
+
+/** Thread's private memory for como data (watcher reload), used
+    instead of como_mem. */
+static __thread plam_t local_mem = NULL;
+
+/** Frozen parse results (see: como_freeze()). */
+static void*    frozen_mem = NULL;
+static pl_u64_t frozen_size = 0;
+
+/** Mapped spec cache (see: como_spec_load()). */
+static void*    spec_image = NULL;
+static pl_u64_t spec_image_size = 0;
+
+/** Caller supplied memory (zero-heap mode), used instead of como_mem. */
+static char*    fixed_mem = NULL;
+static pl_u64_t fixed_size = 0;
+static pl_u64_t fixed_used = 0;
+
+/** Allocation alignment in caller supplied memory. */
+#define COMO_MEM_ALIGN 8
+
+/** Memory reserve per command for names, rules, header, and footer. */
+#define COMO_MEM_RESERVE 1024
+
+/** Usage tab width assumed by como_required_mem. */
+#define COMO_MEM_TAB 64
+
+#define mem_get_for_type( type ) ( (type*)mem_get( sizeof( type ) ) )
+
+
+/*
+ * Static tracepoints (USDT, provider "como"). Enabled with
+ * COMO_USDT. A probe is a nop instruction when not attached.
+ */
+#ifdef COMO_USDT
+#define COMO_PROBE1( name, a ) DTRACE_PROBE1( como, name, a )
+#define COMO_PROBE2( name, a, b ) DTRACE_PROBE2( como, name, a, b )
+#define COMO_PROBE3( name, a, b, c ) DTRACE_PROBE3( como, name, a, b, c )
+#else
+#define COMO_PROBE1( name, a )
+#define COMO_PROBE2( name, a, b )
+#define COMO_PROBE3( name, a, b, c )
+#endif
+
+/** Token classes for "token" probe. */
+#define COMO_TOKEN_TERMINATOR 1
+#define COMO_TOKEN_OPTION 2
+#define COMO_TOKEN_POSITIONAL 3
+
 
 /*
  * ------------------------------------------------------------
  * Como internal vars.
  */
 
-/** Command line argument index. */
-static pl_i64_t arg_idx;
+/*
+ * Parse state is per thread, since watcher reloads in its own thread
+ * (see: watch_reload()).
+ */
+
+/** Arguments under parsing (como_argc and como_argv, unless private
+    results are parsed), and argument index. */
+static __thread pl_i64_t arg_cnt;
+static __thread char**   arg_vec;
+static __thread pl_i64_t arg_idx;
+
+/** Argument classes and lengths (see: args_classify()). */
+static __thread pl_u8_t*  arg_class = NULL;
+static __thread pl_u32_t* arg_len = NULL;
+static __thread pl_i64_t  arg_cap = 0;
 
-/** Global list of commands. */
+/** Option occurrence at argument (or NULL), and its value range. */
+static __thread como_opt_p arg_opt = NULL;
+static __thread pl_u32_t*  arg_value = NULL;
+static __thread pl_u32_t*  arg_valuecnt = NULL;
+
+/** Validation is deferred to worker pool (after parsing). */
+static __thread pl_bool_t valid_deferred = pl_false;
+
+/** Global list of commands (pointers). */
 static plcm_s cmd_list;
 
 /** Main command configuration. */
 static como_config_t como_conf = NULL;
 
+/** Server and batch mode: quit returns to request loop. */
+static __thread pl_bool_t serve_active = pl_false;
+static __thread jmp_buf   serve_jmp;
+static __thread int       serve_status;
+static pl_bool_t          serve_stop = pl_false;
+
+/** Output and error streams (NULL for stdout and stderr). */
+static __thread FILE* out_fh = NULL;
+static __thread FILE* err_fh = NULL;
+
+/** Main command of thread's private parse results (or NULL): batch
+    handler's imported results, or watcher reload. */
+static __thread como_cmd_t local_main = NULL;
+
+/** Hot reload: watched file, command line, callback, and watcher. */
+static const char*      watch_file = NULL;
+static como_cmd_t       watch_main = NULL;
+static pl_i64_t         watch_argc;
+static char**           watch_argv;
+static como_change_fn_t watch_fn;
+static void*            watch_arg;
+static int              watch_fd = -1;
+static pthread_t        watch_thread;
+static sem_t            watch_ready;
+static pl_bool_t        watch_stop;
+
+/** Published snapshot, and readers of even and odd epoch. */
+static como_snap_t snap_current = NULL;
+static pl_u64_t    snap_epoch = 0;
+static pl_i64_t    snap_readers[ 2 ];
+
+/** Specification of automatic help option. */
+static const como_opt_spec_s como_help_spec = {
+    COMO_P_NONE | COMO_P_OPT | COMO_P_HIDDEN | COMO_P_MUTEX,
+    "help", "-h", "Display usage info.", NULL, "--help"
+};
+
+/** Value array for options without values. */
+static char* como_no_values[ 1 ] = { NULL };
+
+
+/** Minimum number of option values for parallel validation. */
+#define COMO_PAR_MIN_VALUES 4096
+
+/** Minimum number of option values per validation chunk. */
+#define COMO_PAR_MIN_CHUNK 1024
+
+/** Maximum number of validation threads. */
+#define COMO_PAR_MAX_THREADS 64
+
+
+/** Maximum name length for suggestion (longer are truncated). */
+#define COMO_SUGGEST_LEN 64
+
+/** Maximum number of suggested names. */
+#define COMO_SUGGEST_MAX 3
+
+
+/** Poll interval of watcher thread (for stop) in ms. */
+#define COMO_WATCH_POLL_MS 200
+
+
+/** Argument classes. */
+#define COMO_ARG_POSITIONAL 0 /**< Subcmd or value. */
+#define COMO_ARG_SHORT 1      /**< "-x". */
+#define COMO_ARG_LONG 2       /**< "--name". */
+#define COMO_ARG_DASH 3       /**< "-". */
+#define COMO_ARG_TERMINATOR 4 /**< "--". */
+
+
+/** Incremental parse journal steps. */
+#define COMO_STEP_TOKEN 0    /**< Token boundary (parsing starts). */
+#define COMO_STEP_VALUE 1    /**< Value added to option. */
+#define COMO_STEP_GIVEN 2    /**< Option given. */
+#define COMO_STEP_COUNT 3    /**< Command given count incremented. */
+#define COMO_STEP_SUBCMD 4   /**< Subcmd given. */
+#define COMO_STEP_EXTERNAL 5 /**< External arguments set. */
+#define COMO_STEP_ERROR 6    /**< Error reported. */
+#define COMO_STEP_OCCUR 7    /**< Option occurrence recorded. */
+
+
+/** Server request identification. */
+#define COMO_SERVE_MAGIC 0x53524f43
+/** Initial memory for server (or batch) request. */
+#define COMO_SERVE_MEM_SIZE 64 * 1024
+
+/** Maximum server request payload size. */
+#define COMO_SERVE_MAX_SIZE ( 16 * 1024 * 1024 )
+
+
+/**
+ * Server request header. Header is followed by payload: cwd, argv,
+ * and env strings (null terminated). Client fds (stdin, stdout, and
+ * stderr) are passed with the header.
+ */
+pl_struct( serve_req )
+{
+    pl_u32_t magic;
+    pl_u32_t argc;
+    pl_u32_t envc;
+    pl_u32_t size; /**< Payload size. */
+};
+
+
+/** Batch command line, i.e. parse results for handler. */
+pl_struct( batch_job )
+{
+    FILE*             fh;      /**< Output stream. */
+    char*             output;  /**< Output buffer. */
+    size_t            outsize; /**< Output size. */
+    void*             buf;     /**< Exported parse results. */
+    pl_i64_t          size;    /**< Exported size. */
+    como_handler_fn_t fn;      /**< Handler (or NULL). */
+    void*             arg;     /**< Handler argument. */
+    int               status;  /**< Exit status. */
+};
+
+
+/** Batch worker with own range of jobs (stolen by others when idle). */
+pl_struct( batch_worker )
+{
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pl_i64_t        beg;     /**< First job of own range. */
+    pl_i64_t        end;     /**< End of own range. */
+    batch_job_t*    jobs;    /**< All jobs. */
+    void*           workers; /**< All workers. */
+    pl_i64_t        id;      /**< Worker index. */
+    pl_i64_t        cnt;     /**< Number of workers. */
+};
+
+
+/** Validation work item, i.e. range of option values. */
+pl_struct( valid_chunk )
+{
+    como_cmd_t cmd;
+    como_opt_t opt;
+    pl_i64_t   beg;
+    pl_i64_t   end;
+};
+
+
+/** Failed option value. */
+pl_struct( valid_fail )
+{
+    como_cmd_t cmd;
+    como_opt_t opt;
+    char*      value;
+};
+
+
+/** Compiled declarative check. */
+pl_struct( check_comp )
+{
+    const como_check_s* check;
+    const char**        slots;   /**< Perfect hash table for enum. */
+    pl_u32_t*           seeds;   /**< Displacement seed per bucket. */
+    pl_u64_t            size;    /**< Hash table size. */
+    pl_u64_t            buckets; /**< Bucket count. */
+    regex_t             re;      /**< Compiled regexp. */
+};
+
+
+/** Export buffer identification. */
+#define COMO_EXPORT_MAGIC 0x4f4d4f43
+/** Export buffer format version. */
+#define COMO_EXPORT_VERSION 3
+
+/** Command option bitsets. */
+#define COMO_BITS_GIVEN( cmd ) ( ( cmd )->bits )
+#define COMO_BITS_REQUIRED( cmd ) ( ( cmd )->bits + ( cmd )->bitwords )
+#define COMO_BITS_MUTEX( cmd ) ( ( cmd )->bits + 2 * ( cmd )->bitwords )
+
+
+/** Export buffer header. */
+pl_struct( export_hdr )
+{
+    pl_u32_t magic;
+    pl_u32_t version;
+    pl_u64_t size;     /**< Buffer size. */
+    pl_u64_t cmdcnt;   /**< Number of commands. */
+    pl_u64_t optcnt;   /**< Number of options. */
+    pl_u64_t idxcnt;   /**< Number of index entries. */
+    pl_u64_t external; /**< Index of external args. */
+    pl_u64_t extcnt;   /**< Number of external args. */
+    pl_u64_t hasext;   /**< External args exist. */
+    pl_u64_t key;      /**< Spec cache key string (zero for none). */
+};
+
+
+/** Exported command. Strings are buffer offsets (zero for NULL). */
+pl_struct( export_cmd )
+{
+    pl_u64_t name;
+    pl_u64_t longname;
+    pl_u64_t author;
+    pl_u64_t year;
+    pl_u64_t header;
+    pl_u64_t footer;
+    pl_i64_t parent;   /**< Parent command index (or -1). */
+    pl_u64_t opt;      /**< Index of first option. */
+    pl_u64_t optcnt;   /**< Number of options. */
+    pl_u64_t specsize; /**< Number of specified options. */
+    pl_u64_t sub;      /**< Index of subcmd indeces. */
+    pl_u64_t subcnt;   /**< Number of subcmds. */
+    pl_u64_t order;    /**< Index of occurrence order (option, occurrence). */
+    pl_u64_t ordercnt; /**< Number of occurrences. */
+    pl_i64_t givencnt;
+    pl_i64_t errors;
+    pl_i64_t tab;
+    pl_i64_t threads;
+    pl_i64_t map_dup;
+    pl_u8_t  given;
+    pl_u8_t  autohelp;
+    pl_u8_t  subcheck;
+    pl_u8_t  check_missing;
+    pl_u8_t  check_invalid;
+    pl_u8_t  help_exit;
+};
+
+
+/** Exported option. */
+pl_struct( export_opt )
+{
+    pl_u64_t type;
+    pl_u64_t name;
+    pl_u64_t shortopt;
+    pl_u64_t doc;
+    pl_u64_t longopt;
+    pl_u64_t value;    /**< Index of value string offsets. */
+    pl_u64_t valuecnt;
+    pl_u64_t occur;    /**< Index of occurrences (two entries each). */
+    pl_u64_t occurcnt;
+    pl_u8_t  given;
+    pl_u8_t  hasvalue; /**< Value array exists. */
+};
+
+
+/** Export state. */
+pl_struct( export )
+{
+    char*      buf;     /**< Buffer (NULL when sizing). */
+    pl_u64_t   cmdcnt;  /**< Command count (or position). */
+    pl_u64_t   optcnt;  /**< Option count (or position). */
+    pl_u64_t   idxcnt;  /**< Index count (or position). */
+    pl_u64_t   strpos;  /**< String area size (or position). */
+    pl_u64_t*  idx;     /**< Index array. */
+    export_cmd_t cmds;  /**< Command array. */
+    export_opt_t opts;  /**< Option array. */
+};
+
+
+/** Name suggestion node. Children are linked by sibling. */
+pl_struct_body( como_bknode )
+{
+    const char*   name;    /**< Option switch or subcmd name. */
+    pl_i64_t      idx;     /**< Insertion order. */
+    pl_bool_t     subcmd;  /**< Subcmd name. */
+    pl_i64_t      dist;    /**< Distance to parent. */
+    como_bknode_t child;   /**< First child. */
+    como_bknode_t sibling; /**< Next child of parent. */
+};
+
+
+/** Validation worker. */
+pl_struct( valid_worker )
+{
+    pthread_t     thread;
+    valid_chunk_t chunks;   /**< Shared work items. */
+    pl_i64_t      chunkcnt; /**< Number of work items. */
+    pl_i64_t*     next;     /**< Shared index of next work item. */
+    plcm_s        fails;    /**< Failures found by worker. */
+};
+
+
+/** Incremental parse journal step. */
+pl_struct( parse_step )
+{
+    pl_i64_t   kind;
+    pl_i64_t   idx; /**< Argument index (token). */
+    como_cmd_t cmd;
+    como_opt_t opt;
+};
+
+
+/** Incremental parse state. */
+pl_struct( parse_state )
+{
+    como_parse_s parse;   /**< Public part. */
+    char**       args;    /**< Own copies of arguments (NULL terminated). */
+    pl_i64_t     argcnt;
+    pl_i64_t     argcap;
+    parse_step_t steps;   /**< Journal. */
+    pl_i64_t     stepcnt;
+    pl_i64_t     stepcap;
+    char*        membuf;
+    plam_s       mem;     /**< Memory for option values. */
+    FILE*        fh;      /**< Message stream. */
+    char*        msgbuf;
+    size_t       msgsize;
+};
+
+
+/** Active incremental parse (journal recording). */
+static __thread parse_state_t parse_journal = NULL;
+
 
 /*
  * ------------------------------------------------------------
@@ -65,6 +478,166 @@ void como_fatal( const char* format, ... )
 }
 
 
+static void quit( int status );
+
+
+/**
+ * Return command for queries without command argument: main command
+ * of the thread's private parse results (batch handler or watcher
+ * reload), otherwise como_cmd.
+ *
+ * @return Command.
+ */
+static inline como_cmd_t query_cmd( void )
+{
+    return local_main ? local_main : como_cmd;
+}
+
+
+/**
+ * Round size up to allocation alignment.
+ *
+ * @param size Size.
+ *
+ * @return Aligned size.
+ */
+static pl_u64_t mem_align( pl_u64_t size )
+{
+    return ( size + COMO_MEM_ALIGN - 1 ) & ~( (pl_u64_t)COMO_MEM_ALIGN - 1 );
+}
+
+
+/**
+ * Allocate memory for como data. In zero-heap mode memory is taken
+ * from caller supplied buffer and running out of it is fatal. Thread
+ * with private memory (watcher reload) allocates from it.
+ *
+ * @param size Size in bytes.
+ *
+ * @return Memory.
+ */
+static void* mem_get( pl_u64_t size )
+{
+    void* ret;
+
+    if ( local_mem ) {
+        return plam_get( local_mem, size );
+    }
+
+    if ( !fixed_mem ) {
+        return plam_get( &como_mem, size );
+    }
+
+    size = mem_align( size );
+    if ( fixed_used + size > fixed_size ) {
+        como_fatal( "Out of memory (%llu of %llu bytes used, %llu requested)!\n",
+                    (unsigned long long)fixed_used,
+                    (unsigned long long)fixed_size,
+                    (unsigned long long)size );
+        quit( EXIT_FAILURE );
+    }
+
+    ret = fixed_mem + fixed_used;
+    fixed_used += size;
+
+    return ret;
+}
+
+
+/**
+ * Store copy of string to como memory.
+ *
+ * @param str String.
+ *
+ * @return Copy.
+ */
+static char* mem_store_string( const char* str )
+{
+    pl_u64_t len;
+    char*    ret;
+
+    if ( local_mem ) {
+        return plam_store_string( local_mem, str );
+    }
+
+    if ( !fixed_mem ) {
+        return plam_store_string( &como_mem, str );
+    }
+
+    len = strlen( str ) + 1;
+    ret = mem_get( len );
+    memcpy( ret, str, len );
+
+    return ret;
+}
+
+
+/**
+ * Format string to como memory.
+ *
+ * @param format Format.
+ *
+ * @return Formatted string.
+ */
+static char* mem_format_string( const char* format, ... )
+{
+    va_list ap;
+    int     len;
+    char*   ret;
+
+    va_start( ap, format );
+    len = vsnprintf( NULL, 0, format, ap );
+    va_end( ap );
+
+    ret = mem_get( len + 1 );
+
+    va_start( ap, format );
+    vsnprintf( ret, len + 1, format, ap );
+    va_end( ap );
+
+    return ret;
+}
+
+
+/**
+ * Store pointer to terminated pointer array in caller supplied
+ * memory. Array capacity doubles from initial, and old array is left
+ * in place (no free in bump allocation).
+ *
+ * @param cm Pointer array.
+ * @param ptr Pointer to store.
+ * @param init Initial capacity (power of two).
+ */
+static void fixed_store_ptr( plcm_t cm, void* ptr, pl_u64_t init )
+{
+    pl_u64_t cnt, cap;
+    void*    data;
+
+    cnt = plcm_data( cm ) ? plcm_used_ptr( cm ) : 0;
+
+    /* Current capacity: cnt items and terminator fit. */
+    cap = init;
+    while ( cap < cnt + 1 ) {
+        cap <<= 1;
+    }
+
+    if ( !plcm_data( cm ) || cnt + 2 > cap ) {
+        if ( plcm_data( cm ) ) {
+            cap <<= 1;
+        }
+        data = plcm_data( cm );
+        plcm_use( cm, mem_get( cap * sizeof( void* ) ), cap * sizeof( void* ) );
+        if ( cnt > 0 ) {
+            memcpy( plcm_data( cm ), data, cnt * sizeof( void* ) );
+        }
+        cm->used = cnt * sizeof( void* );
+    }
+
+    plcm_store_ptr( cm, ptr );
+    plcm_terminate_ptr( cm );
+}
+
+
 /**
  * Create como_cmd_s data structure.
  *
@@ -74,49 +647,81 @@ static como_cmd_t cmd_create( void )
 {
     como_cmd_t cmd;
 
-    cmd = plcm_get_ref_for_type( &cmd_list, como_cmd_s );
+    cmd = mem_get_for_type( como_cmd_s );
+    if ( fixed_mem ) {
+        fixed_store_ptr( &cmd_list, cmd, 16 );
+    } else {
+        plcm_store_ptr( &cmd_list, cmd );
+    }
     cmd->name = NULL;
     cmd->longname = NULL;
     cmd->author = NULL;
     cmd->year = NULL;
     cmd->givencnt = 0;
+    cmd->order = NULL;
+    cmd->ordercnt = 0;
     cmd->given = pl_false;
     cmd->errors = 0;
     cmd->parent = NULL;
-    plcm_empty( &cmd->subcmds, 32 * sizeof( como_cmd_t ) );
+    cmd->external = NULL;
+
+    /* Subcmds array is created when first subcmd is added. */
+    memset( &cmd->subcmds, 0, sizeof( plcm_s ) );
 
     cmd->opts = NULL;
+    cmd->keys = NULL;
+    cmd->spec = NULL;
+    cmd->specsize = 0;
+    cmd->image = NULL;
+    cmd->plugin = NULL;
+    cmd->plugin_handle = NULL;
+    cmd->bits = NULL;
+    cmd->bitwords = 0;
+    cmd->rules = NULL;
+    cmd->suggest = NULL;
+    cmd->handler = NULL;
+    cmd->handler_arg = NULL;
 
     return cmd;
 }
 
 
 /**
- * Create and setup como_opt_s data structure.
+ * Return side entry of option, and create it if missing.
  *
- * @param type Option type.
- * @param name Option name.
- * @param opt Option mnemonic.
- * @param doc Option documentaion.
+ * @param o Option.
  *
- * @return Structure.
+ * @return Entry.
  */
-static como_opt_t opt_create( como_opt_type_t type,
-                              const char*     name,
-                              const char*     opt,
-                              const char*     doc )
+static como_opt_ext_t opt_ext( como_opt_t o )
 {
-    como_opt_t co;
+    if ( !o->ext ) {
+        o->ext = mem_get_for_type( como_opt_ext_s );
+        memset( o->ext, 0, sizeof( como_opt_ext_s ) );
+    }
+
+    return o->ext;
+}
+
 
-    co = plam_get_for_type( &como_mem, como_opt_s );
+/**
+ * Setup como_opt_s data structure. Strings are referenced from the
+ * specification.
+ *
+ * @param co Option to setup.
+ * @param spec Option specification.
+ */
+static void opt_setup( como_opt_t co, const como_opt_spec_s* spec )
+{
+    como_opt_type_t type = spec->type;
 
     if ( type == COMO_DEFAULT ) {
         /* Force these for default type. */
         co->name = "<default>";
         co->shortopt = "<default>";
     } else {
-        co->name = name;
-        co->shortopt = opt;
+        co->name = spec->name;
+        co->shortopt = spec->opt;
     }
 
     /* Convert type definition to primitives. */
@@ -148,1007 +753,5959 @@ static como_opt_t opt_create( como_opt_type_t type,
         case COMO_SILENT:
             type = COMO_P_NONE | COMO_P_OPT | COMO_P_HIDDEN;
             break;
+        case COMO_MAP:
+            type = COMO_P_ONE | COMO_P_MANY | COMO_P_OPT | COMO_P_MAP;
+            break;
+        case COMO_COUNT:
+            type = COMO_P_NONE | COMO_P_OPT | COMO_P_COUNT;
+            break;
         default:
             break;
     }
 
     co->type = type;
-    co->doc = doc;
+    co->doc = spec->doc;
 
-    co->longopt = plam_format_string( &como_mem, "--%s", co->name );
+    if ( spec->longopt ) {
+        co->longopt = (char*)spec->longopt;
+    } else {
+        co->longopt = mem_format_string( "--%s", co->name );
+    }
 
-    plcm_use_plam( &co->value_store, &como_mem, 32 * sizeof( char* ) );
-    plcm_terminate_ptr( &co->value_store );
+    /* Value store is created when first value is added. */
+    memset( &co->value_store, 0, sizeof( plcm_s ) );
     co->value = NULL;
+    co->valuelen = NULL;
     co->valuecnt = 0;
     co->given = pl_false;
+    co->occur = NULL;
+    co->occurcnt = 0;
+    co->ext = NULL;
 
-    return co;
+    /* Map options have table in side entry. */
+    if ( co->type & COMO_P_MAP ) {
+        opt_ext( co );
+    }
 }
 
 
 /**
- * Create como_config_s data structure.
+ * Return start of name as integer (for fast comparison).
  *
- * @return Structure.
+ * @param name Name.
+ * @param len Name length.
+ *
+ * @return Prefix.
  */
-static como_config_t config_create( void )
+static pl_u64_t name_prefix( const char* name, pl_u64_t len )
 {
-    como_config_t conf;
-
-    conf = plam_get_for_type( &como_mem, como_config_s );
+    pl_u64_t prefix = 0;
 
-    /* Setup config defaults. */
-    conf->autohelp = pl_true;
-    conf->header = NULL;
-    conf->footer = NULL;
-    conf->subcheck = pl_true;
-    conf->check_missing = pl_true;
-    conf->check_invalid = pl_true;
-    conf->tab = 12;
-    conf->help_exit = pl_true;
+    memcpy( &prefix, name, len < sizeof( pl_u64_t ) ? len : sizeof( pl_u64_t ) );
 
-    return conf;
+    return prefix;
 }
 
 
 /**
- * Duplicate configuration.
+ * Return size of option lookup keys.
  *
- * @param src Source data.
+ * @param cnt Number of options.
  *
- * @return New config.
+ * @return Size in bytes.
  */
-static como_config_t config_dup( como_config_t src )
+static pl_u64_t keys_size( pl_i64_t cnt )
 {
-    como_config_t conf;
-
-    conf = config_create();
-
-    /* Setup config defaults. */
-    conf->autohelp = src->autohelp;
-    conf->header = plam_store_string( &como_mem, src->header );
-    conf->footer = plam_store_string( &como_mem, src->footer );
-    conf->subcheck = src->subcheck;
-    conf->check_missing = src->check_missing;
-    conf->check_invalid = src->check_invalid;
-    conf->tab = src->tab;
-    conf->help_exit = src->help_exit;
-
-    return conf;
+    return sizeof( como_keys_s ) +
+           cnt * ( sizeof( pl_u64_t ) + 2 * sizeof( char* ) + 2 * sizeof( pl_u32_t ) );
 }
 
 
 /**
- * Find command by name.
- *
- * @param name Name.
+ * Setup option lookup keys for command. Keys are stored to contiguous
+ * arrays for cache-efficient scanning.
  *
- * @return Command.
+ * @param cmd Command with options.
+ * @param mem Memory for keys (see: keys_size).
  */
-static como_cmd_t find_cmd_by_name( char* name )
+static void keys_setup( como_cmd_t cmd, char* mem )
 {
-    for ( como_cmd_t cmd = plcm_data( &cmd_list ); (pl_t)cmd < plcm_end( &cmd_list ); cmd++ ) {
-        if ( strcmp( cmd->name, name ) == 0 ) {
-            return cmd;
-        }
+    como_keys_t keys;
+    pl_i64_t    cnt = cmd->optcnt;
+
+    keys = (como_keys_t)mem;
+    mem += sizeof( como_keys_s );
+    keys->prefix = (pl_u64_t*)mem;
+    mem += cnt * sizeof( pl_u64_t );
+    keys->name = (const char**)mem;
+    mem += cnt * sizeof( char* );
+    keys->shortopt = (const char**)mem;
+    mem += cnt * sizeof( char* );
+    keys->type = (pl_u32_t*)mem;
+    mem += cnt * sizeof( pl_u32_t );
+    keys->longlen = (pl_u32_t*)mem;
+
+    for ( pl_i64_t i = 0; i < cnt; i++ ) {
+        como_opt_t o = cmd->opts[ i ];
+        keys->type[ i ] = o->type;
+        keys->name[ i ] = o->name;
+        keys->shortopt[ i ] = o->shortopt;
+        keys->longlen[ i ] = strlen( o->name );
+        keys->prefix[ i ] = name_prefix( o->name, keys->longlen[ i ] );
     }
 
-    return NULL;
+    cmd->keys = keys;
 }
 
 
 /**
- * Add subcmd command to parents list.
+ * Create option lookup keys for command.
  *
- * @param parent Host for subcmd.
- * @param subcmd Subcmd to add.
+ * @param cmd Command with options.
  */
-static void add_subcmd( como_cmd_t parent, como_cmd_t subcmd )
+static void keys_create( como_cmd_t cmd )
 {
-    plcm_store_ptr( &parent->subcmds, subcmd );
+    keys_setup( cmd, mem_get( keys_size( cmd->optcnt ) ) );
 }
 
 
 /**
- * Find option by type.
+ * Calculate hash for check enum value.
  *
- * @param cmd Command including option.
- * @param type Option type.
+ * @param str String to hash.
  *
- * @return Option (or NULL).
+ * @return Hash.
  */
-static como_opt_t find_opt_by_type( como_cmd_t cmd, como_opt_type_t type )
+static pl_u64_t check_hash( const char* str )
 {
-    pl_i64_t i = 0;
+    pl_u64_t h = 14695981039346656037ULL;
 
-    while ( cmd->opts[ i ] ) {
-        if ( cmd->opts[ i ]->type & type ) {
-            return cmd->opts[ i ];
-        }
-        i++;
+    while ( *str ) {
+        h ^= (pl_u8_t)*str++;
+        h *= 1099511628211ULL;
     }
 
-    return NULL;
+    return h ^ ( h >> 29 );
 }
 
 
 /**
- * Find option by name.
+ * Return check enum table slot for hash with bucket seed.
  *
- * @param cmd Command including option.
- * @param name Option name (or NULL for COMO_DEFAULT arg).
+ * @param h Value hash.
+ * @param seed Bucket seed.
+ * @param size Table size.
  *
- * @return Option (or NULL).
+ * @return Slot index.
  */
-static como_opt_t find_opt_by_name( como_cmd_t cmd, char* name )
+static pl_u64_t check_slot( pl_u64_t h, pl_u32_t seed, pl_u64_t size )
 {
-    pl_i64_t i = 0;
+    h ^= ( seed + 1 ) * 0x9e3779b97f4a7c15ULL;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
 
-    if ( name == NULL ) {
-        /* Find default arg. */
-        return find_opt_by_type( cmd, COMO_P_DEFAULT );
-    } else {
-        while ( cmd->opts[ i ] ) {
-            if ( strcmp( cmd->opts[ i ]->name, name ) == 0 ) {
-                return cmd->opts[ i ];
-            }
-            i++;
-        }
-    }
+    return h % size;
+}
 
-    return NULL;
+
+/**
+ * Return number of check enum values.
+ *
+ * @param set Values (NULL terminated).
+ *
+ * @return Count.
+ */
+static pl_u64_t check_enum_count( const char** set )
+{
+    pl_u64_t cnt = 0;
+
+    while ( set[ cnt ] ) {
+        cnt++;
+    }
+
+    return cnt;
 }
 
 
 /**
- * Find option by characterics:
- *  - Default type is searched if str is NULL.
- *  - Long option is searched if str starts with "--".
- *  - Short option is searched if str starts with "-".
- *  - Named option is searched otherwise.
+ * Return size of check enum hash table with seeds.
  *
- * @param cmd Command including option.
- * @param str Option tag to search for.
+ * @param cnt Number of values.
+ * @param [out] size Table size.
+ * @param [out] buckets Bucket count.
  *
- * @return Option (or NULL).
+ * @return Size in bytes.
  */
-static como_opt_t find_opt( como_cmd_t cmd, char* str )
+static pl_u64_t check_enum_size( pl_u64_t cnt, pl_u64_t* size, pl_u64_t* buckets )
 {
-    pl_i64_t i = 0;
+    /* Table has load factor 0.8, and buckets four values on average. */
+    *size = cnt + cnt / 4 + 1;
+    *buckets = cnt / 4 + 1;
 
-    if ( str == NULL ) {
-        /* Default option. */
-        while ( cmd->opts[ i ] ) {
-            if ( cmd->opts[ i ]->type & COMO_P_DEFAULT ) {
-                return cmd->opts[ i ];
-            }
-            i++;
+    return *size * sizeof( char* ) + mem_align( *buckets * sizeof( pl_u32_t ) );
+}
+
+
+/**
+ * Build minimal perfect hash table for check enum values (hash and
+ * displace). Values are distributed to buckets, and buckets are placed
+ * from the largest by searching a seed that maps all bucket values to
+ * free slots. Duplicate values hash to the same slot, and they are
+ * stored once. Lookup hashes the value once.
+ *
+ * @param cc Compiled check.
+ */
+static void check_enum_build( check_comp_t cc )
+{
+    const char** set = cc->check->set;
+    pl_u64_t     cnt, bytes, b, k, maxk, *hash, *slot;
+    pl_u32_t     *first, *order, seed, i, j;
+    char*        mem;
+    pl_bool_t    ok;
+
+    cnt = check_enum_count( set );
+    bytes = check_enum_size( cnt, &cc->size, &cc->buckets );
+
+    /* Table and seeds are allocated once. */
+    mem = mem_get( bytes );
+    memset( mem, 0, bytes );
+    cc->slots = (const char**)mem;
+    cc->seeds = (pl_u32_t*)( mem + cc->size * sizeof( char* ) );
+
+    /* Temporary hashes, bucket lists, and bucket slots. */
+    hash = malloc( cnt * 2 * sizeof( pl_u64_t ) + ( cc->buckets + 1 + cnt ) * sizeof( pl_u32_t ) );
+    if ( !hash ) {
+        como_fatal( "Out of memory for enum check!" );
+        return;
+    }
+    slot = hash + cnt;
+    first = (pl_u32_t*)( slot + cnt );
+    order = first + cc->buckets + 1;
+
+    /* Bucket values with counting sort (first has bucket starts). */
+    memset( first, 0, ( cc->buckets + 1 ) * sizeof( pl_u32_t ) );
+    for ( i = 0; i < cnt; i++ ) {
+        hash[ i ] = check_hash( set[ i ] );
+        first[ ( hash[ i ] >> 32 ) % cc->buckets + 1 ]++;
+    }
+    maxk = 0;
+    for ( b = 0; b < cc->buckets; b++ ) {
+        if ( first[ b + 1 ] > maxk ) {
+            maxk = first[ b + 1 ];
         }
-    } else if ( strncmp( str, "--", 2 ) == 0 ) {
-        /* Long option. */
-        while ( cmd->opts[ i ] ) {
-            if ( strcmp( cmd->opts[ i ]->longopt, str ) == 0 ) {
-                return cmd->opts[ i ];
+        first[ b + 1 ] += first[ b ];
+    }
+    for ( i = 0; i < cnt; i++ ) {
+        b = ( hash[ i ] >> 32 ) % cc->buckets;
+        order[ first[ b ] + cc->seeds[ b ]++ ] = i;
+    }
+
+    /* Place buckets from the largest. */
+    for ( k = maxk; k > 0; k-- ) {
+        for ( b = 0; b < cc->buckets; b++ ) {
+            if ( first[ b + 1 ] - first[ b ] != k ) {
+                continue;
+            }
+            for ( seed = 0;; seed++ ) {
+                if ( seed == UINT32_MAX ) {
+                    como_fatal( "Enum check values can't be hashed!" );
+                    free( hash );
+                    return;
+                }
+                ok = pl_true;
+                for ( i = first[ b ]; ok && i < first[ b + 1 ]; i++ ) {
+                    slot[ i ] = check_slot( hash[ order[ i ] ], seed, cc->size );
+                    if ( cc->slots[ slot[ i ] ] ) {
+                        ok = pl_false;
+                    }
+                    for ( j = first[ b ]; ok && j < i; j++ ) {
+                        if ( slot[ j ] == slot[ i ] &&
+                             strcmp( set[ order[ j ] ], set[ order[ i ] ] ) != 0 ) {
+                            ok = pl_false;
+                        }
+                    }
+                }
+                if ( ok ) {
+                    break;
+                }
+            }
+            cc->seeds[ b ] = seed;
+            for ( i = first[ b ]; i < first[ b + 1 ]; i++ ) {
+                cc->slots[ slot[ i ] ] = set[ order[ i ] ];
             }
-            i++;
         }
-    } else if ( str[ 0 ] == '-' ) {
-        /* Short option. */
-        while ( cmd->opts[ i ] ) {
-            if ( cmd->opts[ i ]->shortopt && strcmp( cmd->opts[ i ]->shortopt, str ) == 0 ) {
-                return cmd->opts[ i ];
+    }
+
+    free( hash );
+}
+
+
+/**
+ * Parse number with unit suffix.
+ *
+ * @param value Value to parse.
+ * @param units Unit suffixes (NULL terminated).
+ * @param mults Multipliers for units.
+ * @param [out] res Result.
+ *
+ * @return True if value is valid.
+ */
+static pl_bool_t check_parse_unit( const char*  value,
+                                   const char** units,
+                                   pl_i64_t*    mults,
+                                   pl_i64_t*    res )
+{
+    char*    end;
+    pl_i64_t num;
+
+    errno = 0;
+    num = strtoll( value, &end, 10 );
+    if ( end == value || errno != 0 ) {
+        return pl_false;
+    }
+
+    for ( pl_i64_t i = 0; units[ i ]; i++ ) {
+        if ( strcmp( end, units[ i ] ) == 0 ) {
+            if ( num > INT64_MAX / mults[ i ] || num < INT64_MIN / mults[ i ] ) {
+                return pl_false;
             }
-            i++;
+            *res = num * mults[ i ];
+            return pl_true;
         }
-    } else {
-        /* By name. */
-        return find_opt_by_name( cmd, str );
     }
 
-    return NULL;
+    return pl_false;
 }
 
 
 /**
- * Get current argument from command line.
+ * Run compiled check for value (validator function).
  *
- * @return Argument.
+ * @param value Value to check.
+ * @param arg Compiled check.
+ *
+ * @return True if valid.
  */
-static char* get_arg( void )
+static pl_bool_t check_run( const char* value, void* arg )
 {
-    return como_argv[ arg_idx ];
+    static const char* size_units[] = { "", "K", "KB", "M", "MB", "G", "GB", "T", "TB", NULL };
+    static pl_i64_t    size_mults[] = { 1,
+                                        1LL << 10,
+                                        1LL << 10,
+                                        1LL << 20,
+                                        1LL << 20,
+                                        1LL << 30,
+                                        1LL << 30,
+                                        1LL << 40,
+                                        1LL << 40 };
+    static const char* dur_units[] = { "", "ms", "s", "m", "h", "d", NULL };
+    static pl_i64_t    dur_mults[] = { 1000, 1, 1000, 60 * 1000, 3600 * 1000, 24 * 3600 * 1000 };
+
+    check_comp_t cc = arg;
+    const char*  slot;
+    pl_u64_t     h;
+    pl_i64_t     num;
+    char*        end;
+
+    switch ( cc->check->kind ) {
+        case COMO_CHECK_KIND_ENUM:
+            h = check_hash( value );
+            slot = cc->slots[ check_slot( h, cc->seeds[ ( h >> 32 ) % cc->buckets ], cc->size ) ];
+            return ( slot && strcmp( slot, value ) == 0 );
+
+        case COMO_CHECK_KIND_RANGE:
+            errno = 0;
+            num = strtoll( value, &end, 0 );
+            if ( value[ 0 ] == 0 || *end != 0 || errno != 0 ) {
+                return pl_false;
+            }
+            break;
+
+        case COMO_CHECK_KIND_SIZE:
+            if ( !check_parse_unit( value, size_units, size_mults, &num ) ) {
+                return pl_false;
+            }
+            break;
+
+        case COMO_CHECK_KIND_DURATION:
+            if ( !check_parse_unit( value, dur_units, dur_mults, &num ) ) {
+                return pl_false;
+            }
+            break;
+
+        case COMO_CHECK_KIND_REGEX:
+            return ( regexec( &cc->re, value, 0, NULL, 0 ) == 0 );
+
+        default:
+            return pl_true;
+    }
+
+    return ( num >= cc->check->min && num <= cc->check->max );
 }
 
 
 /**
- * Advance command line argument index.
+ * Compile declarative check to validator.
+ *
+ * @param check Check descriptor.
+ *
+ * @return Validator.
  */
-static void next_arg( void )
+static como_valid_t check_compile( const como_check_s* check )
 {
-    arg_idx++;
+    como_valid_t valid;
+    check_comp_t cc;
+
+    cc = mem_get_for_type( check_comp_s );
+    cc->check = check;
+    cc->slots = NULL;
+
+    if ( check->kind == COMO_CHECK_KIND_ENUM ) {
+        check_enum_build( cc );
+    } else if ( check->kind == COMO_CHECK_KIND_REGEX ) {
+        if ( regcomp( &cc->re, check->pattern, REG_EXTENDED | REG_NOSUB ) != 0 ) {
+            como_fatal( "Invalid regexp \"%s\"!", check->pattern );
+            return NULL;
+        }
+    }
+
+    valid = mem_get_for_type( como_valid_s );
+    valid->fn = check_run;
+    valid->arg = cc;
+
+    return valid;
 }
 
 
 /**
- * Is current command line argument an option?
+ * Create como_config_s data structure.
  *
- * @return True if is.
+ * @return Structure.
  */
-static pl_bool_t is_opt( void )
+static como_config_t config_create( void )
 {
-    char* s;
+    como_config_t conf;
 
-    s = get_arg();
+    conf = mem_get_for_type( como_config_s );
 
-    if ( s[ 0 ] == '-' ) {
-        return pl_true;
-    } else {
-        return pl_false;
-    }
+    /* Setup config defaults. */
+    conf->autohelp = pl_true;
+    conf->header = NULL;
+    conf->footer = NULL;
+    conf->subcheck = pl_true;
+    conf->check_missing = pl_true;
+    conf->check_invalid = pl_true;
+    conf->tab = 12;
+    conf->help_exit = pl_true;
+    conf->threads = 1;
+    conf->map_dup = COMO_MAP_DUP_LAST;
+    conf->refcnt = 1;
+
+    return conf;
 }
 
 
 /**
- * Is option of switch type? Note that default type is also consided a
- * switch.
+ * Duplicate configuration. Header and footer are shared, since they
+ * are never modified in place.
  *
- * @param opt Option to check.
+ * @param src Source data.
  *
- * @return True if is.
+ * @return New config.
  */
-static pl_bool_t has_switch_style_doc( como_opt_t opt )
+static como_config_t config_dup( como_config_t src )
 {
-    if ( ( ( opt->type & COMO_P_NONE ) && !( opt->type & COMO_P_MANY ) ) ||
-         ( opt->type & COMO_P_DEFAULT ) ) {
-        return pl_true;
-    } else {
-        return pl_false;
+    como_config_t conf;
+
+    conf = config_create();
+
+    /* Setup config defaults. */
+    conf->autohelp = src->autohelp;
+    conf->header = src->header;
+    conf->footer = src->footer;
+    conf->subcheck = src->subcheck;
+    conf->check_missing = src->check_missing;
+    conf->check_invalid = src->check_invalid;
+    conf->tab = src->tab;
+    conf->help_exit = src->help_exit;
+    conf->threads = src->threads;
+    conf->map_dup = src->map_dup;
+
+    return conf;
+}
+
+
+/**
+ * Share configuration (copy-on-write).
+ *
+ * @param src Config to share.
+ *
+ * @return Shared config.
+ */
+static como_config_t config_share( como_config_t src )
+{
+    src->refcnt++;
+    return src;
+}
+
+
+/**
+ * Return configuration of command for modification. Shared
+ * configuration is copied first.
+ *
+ * @param cmd Command.
+ *
+ * @return Config.
+ */
+static como_config_t config_own( como_cmd_t cmd )
+{
+    if ( cmd->conf->refcnt > 1 ) {
+        cmd->conf->refcnt--;
+        cmd->conf = config_dup( cmd->conf );
     }
+
+    return cmd->conf;
 }
 
 
 /**
- * Add item to char pointer array pointer. Create new array is it
- * doesn't exist.
+ * Set option bit.
  *
- * @param [out] storage Pointer where allocation is stored.
- * @param [in] item Item to store.
+ * @param set Bitset.
+ * @param idx Option index.
  */
-static void add_value( plcm_t storage, char* item )
+static inline void bits_set( pl_u64_t* set, pl_i64_t idx )
 {
-    plcm_resize( storage, storage->used + 1 );
-    plcm_store_ptr( storage, item );
-    plcm_terminate_ptr( storage );
+    set[ idx >> 6 ] |= 1ULL << ( idx & 63 );
 }
 
 
 /**
- * Check for missing required arguments. Checking ends if exclusive
- * argument is given. Checking continues with subcmd if encountered.
+ * Clear option bit.
  *
- * @param cmd Command to check.
- * @param errcmd Command that had missing options.
+ * @param set Bitset.
+ * @param idx Option index.
+ */
+static inline void bits_clear( pl_u64_t* set, pl_i64_t idx )
+{
+    set[ idx >> 6 ] &= ~( 1ULL << ( idx & 63 ) );
+}
+
+
+/**
+ * Test option bit.
  *
- * @return True if no missing.
+ * @param set Bitset.
+ * @param idx Option index.
+ *
+ * @return True if set.
  */
-static pl_bool_t check_missing( como_cmd_t cmd, como_cmd_p errcmd )
+static inline pl_bool_t bits_test( const pl_u64_t* set, pl_i64_t idx )
 {
-    como_opt_s **opts, *o;
-    pl_bool_t    ret = pl_true;
-    pl_bool_t    subcheck;
-    como_cmd_t   subcmd;
+    return ( set[ idx >> 6 ] >> ( idx & 63 ) ) & 1;
+}
 
-    if ( !cmd->conf->check_missing ) {
-        return pl_true;
-    }
 
-    /* Check for any exclusive args first. Missing are not checked if has exclusives. */
-    opts = cmd->opts;
-    while ( *opts ) {
-        o = *opts;
-        if ( ( o->type & COMO_P_MUTEX ) && o->given ) {
-            return ret;
-        }
-        opts++;
-    }
+/**
+ * Create option bitsets for command. Given, required, and exclusive
+ * sets are stored in one block.
+ *
+ * @param cmd Command.
+ */
+static void bits_create( como_cmd_t cmd )
+{
+    como_opt_t o;
 
-    /* Check for missing options. */
-    opts = cmd->opts;
-    while ( *opts ) {
-        o = *opts;
-        if ( ( o->type != COMO_SUBCMD ) && !( o->type & COMO_P_OPT ) && !o->given ) {
-            como_error( "Option \"%s\" missing for \"%s\"...", como_opt_id( o ), cmd->longname );
-            *errcmd = cmd;
-            return pl_false;
-        }
-        opts++;
-    }
+    cmd->bitwords = ( cmd->optcnt + 63 ) / 64;
+    cmd->bits = mem_get( 3 * cmd->bitwords * sizeof( pl_u64_t ) );
+    memset( cmd->bits, 0, 3 * cmd->bitwords * sizeof( pl_u64_t ) );
 
-    /* Check for missing subcmds. */
-    if ( !plcm_is_empty( &cmd->subcmds ) ) {
-        /* Has subcmds. */
-        if ( cmd->conf->subcheck ) {
-            subcheck = pl_true;
-        } else {
-            subcheck = pl_false;
+    for ( pl_i64_t i = 0; i < cmd->optcnt; i++ ) {
+        o = cmd->opts[ i ];
+        if ( ( o->type != COMO_SUBCMD ) && !( o->type & COMO_P_OPT ) ) {
+            bits_set( COMO_BITS_REQUIRED( cmd ), i );
+        }
+        if ( o->type & COMO_P_MUTEX ) {
+            bits_set( COMO_BITS_MUTEX( cmd ), i );
         }
-    } else {
-        subcheck = pl_false;
     }
+}
 
-    subcmd = como_cmd_given_subcmd( cmd );
 
-    if ( subcmd ) {
-        /* Go to level subcmd level. */
-        return check_missing( subcmd, errcmd );
-    } else if ( subcheck ) {
-        como_error( "Subcommand required for \"%s\"...", cmd->name );
-        *errcmd = cmd;
-        return pl_false;
+/**
+ * Find first option which is in set a and in set b (or not in set b,
+ * if inverted).
+ *
+ * @param a Bitset a.
+ * @param b Bitset b.
+ * @param invert Invert set b.
+ * @param words Number of bitset words.
+ *
+ * @return Option index (or -1 if none).
+ */
+static pl_i64_t bits_first( const pl_u64_t* a, const pl_u64_t* b, pl_bool_t invert, pl_i64_t words )
+{
+    pl_u64_t w;
+
+    for ( pl_i64_t i = 0; i < words; i++ ) {
+        w = a[ i ] & ( invert ? ~b[ i ] : b[ i ] );
+        if ( w ) {
+            return i * 64 + __builtin_ctzll( w );
+        }
     }
 
-    return ret;
+    return -1;
 }
 
 
 /**
- * Parse command line and store given option values to options objects
- * until subcmd is encountered or end.
+ * Count options which are in both sets.
  *
- * @param cmd Command to update.
- * @param subcmd Command to update next.
+ * @param a Bitset a.
+ * @param b Bitset b.
+ * @param words Number of bitset words.
  *
- * @retval 0 if all arguments have been parsed.
- * @retval 1 if should continue with subcmd.
- * @retval 2 if errors in parsing.
+ * @return Count.
  */
-static pl_i64_t parse_opts( como_cmd_t cmd, como_cmd_p subcmd )
+static pl_i64_t bits_count( const pl_u64_t* a, const pl_u64_t* b, pl_i64_t words )
 {
-    como_opt_t o;
-    como_cmd_t c;
+    pl_i64_t cnt = 0;
 
-    while ( get_arg() ) {
+    for ( pl_i64_t i = 0; i < words; i++ ) {
+        cnt += __builtin_popcountll( a[ i ] & b[ i ] );
+    }
 
-        /* Option terminator?. */
-        if ( strcmp( "--", get_arg() ) == 0 ) {
-            /*  Rest of the args do not belong to this program. */
-            next_arg();
-            como_cmd->external = &( como_argv[ arg_idx ] );
-            break;
-        }
+    return cnt;
+}
 
-        else if ( is_opt() ) {
 
-            /* Normal option. */
+/**
+ * Get option by handle. Handle is specification index, and options
+ * array has automatic help (if any) before specified options.
+ *
+ * @param cmd Command.
+ * @param handle Option handle.
+ *
+ * @return Option (or NULL if handle is out of range).
+ */
+static inline como_opt_t opt_at( como_cmd_t cmd, como_handle_t handle )
+{
+    pl_i64_t pos;
 
-            o = find_opt( cmd, get_arg() );
+    pos = handle + cmd->optcnt - cmd->specsize;
+    if ( handle < COMO_HELP_HANDLE || handle >= cmd->specsize || pos < 0 ) {
+        return NULL;
+    }
 
-            if ( !o ) {
+    return cmd->opts[ pos ];
+}
 
-                /* Not found, might be default. */
 
-                if ( cmd->conf->check_invalid ) {
-                    /* Report missing. */
-                    como_error( "Unknown option \"%s\"...", get_arg() );
-                    break;
-                } else {
-                    /* Default option. */
-                    o = find_opt_by_type( cmd, COMO_P_DEFAULT );
-                    if ( !o ) {
-                        como_error( "No default option specified to allow \"%s\"...", get_arg() );
-                        break;
-                    } else {
-                        if ( !plcm_is_empty( &o->value_store ) ) {
-                            cmd->givencnt++;
-                        }
-                        add_value( &( o->value_store ), get_arg() );
-                    }
-                }
-            } else if ( o && ( ( o->type & COMO_P_ONE ) || ( o->type & COMO_P_MANY ) ) ) {
+/**
+ * Setup option specification from spec cache entry.
+ *
+ * @param cmd Command loaded from spec cache.
+ * @param idx Specification index.
+ * @param spec Specification to setup.
+ *
+ * @return Specification.
+ */
+static const como_opt_spec_s* image_spec( como_cmd_t cmd, pl_i64_t idx, como_opt_spec_t spec )
+{
+    export_opt_t eo = (export_opt_t)cmd->image + idx;
+    char*        base = spec_image;
 
-                /* Option with arguments. */
+#define IMAGE_STR( off ) ( ( off ) ? base + ( off ) : NULL )
 
-                next_arg();
+    spec->type = eo->type;
+    spec->name = IMAGE_STR( eo->name );
+    spec->opt = IMAGE_STR( eo->shortopt );
+    spec->doc = IMAGE_STR( eo->doc );
+    spec->check = NULL;
+    spec->longopt = IMAGE_STR( eo->longopt );
 
-                if ( ( get_arg() == NULL || is_opt() ) && !( o->type & COMO_P_NONE ) ) {
-                    como_error( "No argument given for \"%s\"...", como_opt_id( o ) );
-                    break;
-                } else {
+#undef IMAGE_STR
 
-                    char* arg;
+    return spec;
+}
 
-                    if ( o->type & COMO_P_MANY ) {
-                        /* Get all arguments for multi-option. */
-                        while ( get_arg() && !is_opt() ) {
-                            arg = get_arg();
-                            plcm_store_ptr( &( o->value_store ), arg );
-                            next_arg();
-                        }
-                    } else {
-                        if ( o->given ) {
-                            como_error( "Too many arguments for option (\"%s\")...",
-                                        como_opt_id( o ) );
-                            break;
-                        }
-                        arg = get_arg();
-                        plcm_store_ptr( &( o->value_store ), arg );
-                        next_arg();
-                    }
 
-                    o->given = pl_true;
-                    cmd->givencnt++;
-                }
-            } else {
+/**
+ * Compare strings, which may be NULL.
+ *
+ * @param a String.
+ * @param b String.
+ *
+ * @return True if same.
+ */
+static pl_bool_t str_same( const char* a, const char* b )
+{
+    if ( !a || !b ) {
+        return a == b;
+    }
 
-                /* Switch option. */
-                o->given = pl_true;
-                cmd->givencnt++;
-                next_arg();
-            }
+    return strcmp( a, b ) == 0;
+}
+
+
+/**
+ * Setup command configuration from spec cache entry. Configuration
+ * remains shared with parent, if it is the same.
+ *
+ * @param cmd Command loaded from spec cache.
+ * @param ec Spec cache entry.
+ */
+static void image_conf( como_cmd_t cmd, export_cmd_t ec )
+{
+    como_config_t conf = cmd->conf;
+    char*         base = spec_image;
+    char*         header;
+    char*         footer;
+
+    header = ec->header ? base + ec->header : NULL;
+    footer = ec->footer ? base + ec->footer : NULL;
+
+    if ( conf->autohelp == ec->autohelp && conf->subcheck == ec->subcheck &&
+         conf->check_missing == ec->check_missing && conf->check_invalid == ec->check_invalid &&
+         conf->help_exit == ec->help_exit && conf->tab == ec->tab &&
+         conf->threads == ec->threads && conf->map_dup == ec->map_dup &&
+         str_same( conf->header, header ) &&
+         str_same( conf->footer, footer ) ) {
+        return;
+    }
+
+    conf = config_own( cmd );
+    conf->autohelp = ec->autohelp;
+    conf->header = header;
+    conf->footer = footer;
+    conf->subcheck = ec->subcheck;
+    conf->check_missing = ec->check_missing;
+    conf->check_invalid = ec->check_invalid;
+    conf->tab = ec->tab;
+    conf->help_exit = ec->help_exit;
+    conf->map_dup = ec->map_dup;
+    conf->threads = ec->threads;
+}
+
+
+/**
+ * Load plugin of command, and take its specification and handler.
+ * Failure is reported, and command is left without options.
+ *
+ * @param cmd Command.
+ */
+static void plugin_load( como_cmd_t cmd )
+{
+    const como_plugin_s* plugin;
+    void*                handle;
+
+    handle = dlopen( cmd->plugin, RTLD_NOW | RTLD_LOCAL );
+    if ( !handle ) {
+        como_fatal( "Plugin \"%s\" load failed: %s\n", cmd->plugin, dlerror() );
+        cmd->plugin = NULL;
+        return;
+    }
+
+    plugin = dlsym( handle, COMO_PLUGIN_SYMBOL );
+    if ( !plugin ) {
+        como_fatal( "Plugin \"%s\" has no \"%s\"!\n", cmd->plugin, COMO_PLUGIN_SYMBOL );
+        dlclose( handle );
+        cmd->plugin = NULL;
+        return;
+    }
+
+    cmd->plugin = NULL;
+    cmd->plugin_handle = handle;
+    cmd->spec = plugin->spec;
+    cmd->specsize = plugin->size;
+    if ( !cmd->handler ) {
+        cmd->handler = plugin->handler;
+        cmd->handler_arg = plugin->handler_arg;
+    }
+}
+
+
+/**
+ * Create options for command from its specification, unless already
+ * created. Options are created only for commands that are used.
+ *
+ * @param cmd Command.
+ */
+static void cmd_materialize( como_cmd_t cmd )
+{
+    const como_opt_spec_s* ts;
+    como_opt_spec_s        scratch;
+    como_opt_p             opts;
+    como_opt_t             store;
+    pl_i64_t               i, i2;
+
+    if ( cmd->opts ) {
+        return;
+    }
+
+    if ( cmd->plugin ) {
+        plugin_load( cmd );
+    }
+
+    cmd->optcnt = cmd->specsize;
+
+    if ( cmd->conf->autohelp ) {
+        /* Add space for help. */
+        cmd->optcnt++;
+    }
+
+    /* optcnt + NULL. */
+    opts = mem_get( ( cmd->optcnt + 1 ) * sizeof( como_opt_t ) );
+
+    /* Options are stored in one block. */
+    store = mem_get( cmd->optcnt * sizeof( como_opt_s ) );
+    for ( i = 0; i < cmd->optcnt; i++ ) {
+        opts[ i ] = &store[ i ];
+    }
+
+    /* Insert help. */
+    i = 0;
+    if ( cmd->conf->autohelp ) {
+        opt_setup( opts[ i ], &como_help_spec );
+        i++;
+    }
+
+    /* Create options (after help). */
+    i2 = 0;
+    while ( i < cmd->optcnt ) {
+        if ( cmd->spec ) {
+            ts = &cmd->spec[ i2 ];
         } else {
+            ts = image_spec( cmd, i2, &scratch );
+        }
+        opt_setup( opts[ i ], ts );
+        if ( ts->check ) {
+            opt_ext( opts[ i ] )->valid = check_compile( ts->check );
+        }
+        i++;
+        i2++;
+    }
+    opts[ i ] = NULL;
 
-            /* Subcmd or default. Check for Subcmd first. */
-            o = find_opt( cmd, get_arg() );
+    cmd->opts = opts;
+    keys_create( cmd );
+    bits_create( cmd );
+}
 
-            if ( !o || o->type != COMO_SUBCMD ) {
 
-                /* Default argument. */
+/**
+ * Find command by name.
+ *
+ * @param name Name.
+ *
+ * @return Command.
+ */
+static como_cmd_t find_cmd_by_name( char* name )
+{
+    como_cmd_p cmd;
 
-                o = find_opt_by_type( cmd, COMO_P_DEFAULT );
+    /* Search latest first, since parent is usually specified just
+     * before its subcmds. */
+    cmd = plcm_end( &cmd_list );
+    while ( (pl_t)cmd > plcm_data( &cmd_list ) ) {
+        cmd--;
+        if ( strcmp( ( *cmd )->name, name ) == 0 ) {
+            return *cmd;
+        }
+    }
 
-                if ( !o ) {
-                    if ( !plcm_is_empty( &cmd->subcmds ) ) {
-                        como_error( "Unknown subcmd: \"%s\"...", get_arg() );
-                    } else {
-                        como_error( "No default option specified to allow \"%s\"...", get_arg() );
-                    }
-                    next_arg();
-                } else {
-                    if ( !plcm_is_empty( &o->value_store ) ) {
-                        cmd->givencnt++;
-                    }
-                    add_value( &( o->value_store ), get_arg() );
-                    o->given = pl_true;
-                    next_arg();
+    return NULL;
+}
+
+
+/**
+ * Add subcmd command to parents list.
+ *
+ * @param parent Host for subcmd.
+ * @param subcmd Subcmd to add.
+ */
+static void add_subcmd( como_cmd_t parent, como_cmd_t subcmd )
+{
+    if ( fixed_mem ) {
+        fixed_store_ptr( &parent->subcmds, subcmd, 4 );
+        return;
+    }
+
+    if ( plcm_data( &parent->subcmds ) == NULL ) {
+        plcm_use_plam( &parent->subcmds, &como_mem, 4 * sizeof( como_cmd_t ) );
+    }
+    plcm_store_ptr( &parent->subcmds, subcmd );
+}
+
+
+/**
+ * Find option by type.
+ *
+ * @param cmd Command including option.
+ * @param type Option type.
+ *
+ * @return Option (or NULL).
+ */
+static como_opt_t find_opt_by_type( como_cmd_t cmd, como_opt_type_t type )
+{
+    pl_u32_t* types = cmd->keys->type;
+
+    for ( pl_i64_t i = 0; i < cmd->optcnt; i++ ) {
+        if ( types[ i ] & type ) {
+            return cmd->opts[ i ];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Find option by name with length.
+ *
+ * @param cmd Command including option.
+ * @param name Option name.
+ * @param len Name length.
+ *
+ * @return Option (or NULL).
+ */
+static como_opt_t find_opt_by_key( como_cmd_t cmd, const char* name, pl_u64_t len )
+{
+    como_keys_t keys = cmd->keys;
+    pl_u64_t    prefix;
+
+    prefix = name_prefix( name, len );
+
+    for ( pl_i64_t i = 0; i < cmd->optcnt; i++ ) {
+        if ( keys->prefix[ i ] == prefix && keys->longlen[ i ] == len &&
+             ( len <= sizeof( pl_u64_t ) ||
+               memcmp( keys->name[ i ] + sizeof( pl_u64_t ),
+                       name + sizeof( pl_u64_t ),
+                       len - sizeof( pl_u64_t ) ) == 0 ) ) {
+            return cmd->opts[ i ];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Find option by name.
+ *
+ * @param cmd Command including option.
+ * @param name Option name (or NULL for COMO_DEFAULT arg).
+ *
+ * @return Option (or NULL).
+ */
+static como_opt_t find_opt_by_name( como_cmd_t cmd, char* name )
+{
+    if ( name == NULL ) {
+        /* Find default arg. */
+        return find_opt_by_type( cmd, COMO_P_DEFAULT );
+    } else {
+        return find_opt_by_key( cmd, name, strlen( name ) );
+    }
+}
+
+
+/**
+ * Find option by argument class (see: args_classify()):
+ *  - Long option is searched for "--name".
+ *  - Short option is searched for "-x" (and "-").
+ *  - Named option is searched otherwise.
+ *
+ * @param cmd Command including option.
+ * @param idx Argument index.
+ *
+ * @return Option (or NULL).
+ */
+static como_opt_t find_opt_by_arg( como_cmd_t cmd, pl_i64_t idx )
+{
+    const char** shortopt;
+    char*        str = arg_vec[ idx ];
+
+    switch ( arg_class[ idx ] ) {
+        case COMO_ARG_LONG:
+            /* Long option, i.e. "--" and name. */
+            return find_opt_by_key( cmd, str + 2, arg_len[ idx ] - 2 );
+        case COMO_ARG_SHORT:
+        case COMO_ARG_DASH:
+            /* Short option. */
+            shortopt = cmd->keys->shortopt;
+            for ( pl_i64_t i = 0; i < cmd->optcnt; i++ ) {
+                if ( shortopt[ i ] && shortopt[ i ][ 1 ] == str[ 1 ] &&
+                     strcmp( shortopt[ i ], str ) == 0 ) {
+                    return cmd->opts[ i ];
                 }
+            }
+            return NULL;
+        default:
+            /* By name. */
+            return find_opt_by_key( cmd, str, arg_len[ idx ] );
+    }
+}
+
+
+/**
+ * Find option by current argument (see: find_opt_by_arg()), and trace
+ * lookup result.
+ *
+ * @param cmd Command including the option.
+ *
+ * @return Option (or NULL if not found).
+ */
+static inline como_opt_t find_opt( como_cmd_t cmd )
+{
+    como_opt_t o;
+
+    o = find_opt_by_arg( cmd, arg_idx );
+    if ( o ) {
+        COMO_PROBE2( lookup__hit, cmd->name, arg_vec[ arg_idx ] );
+    } else {
+        COMO_PROBE2( lookup__miss, cmd->name, arg_vec[ arg_idx ] );
+    }
+
+    return o;
+}
+
+
+/**
+ * Edit distance with transpositions (Damerau-Levenshtein). Unlike
+ * the restricted variant, this is a metric, which is required by
+ * BK-tree search.
+ *
+ * @param a First string.
+ * @param b Second string.
+ *
+ * @return Distance.
+ */
+static pl_i64_t name_distance( const char* a, const char* b )
+{
+    pl_i32_t d[ COMO_SUGGEST_LEN + 2 ][ COMO_SUGGEST_LEN + 2 ];
+    pl_i32_t da[ 256 ];
+    pl_i32_t la, lb, inf, db, k, l, cost, v;
+
+    la = strnlen( a, COMO_SUGGEST_LEN );
+    lb = strnlen( b, COMO_SUGGEST_LEN );
+    inf = la + lb;
+
+    memset( da, 0, sizeof( da ) );
+
+    d[ 0 ][ 0 ] = inf;
+    for ( pl_i32_t i = 0; i <= la; i++ ) {
+        d[ i + 1 ][ 0 ] = inf;
+        d[ i + 1 ][ 1 ] = i;
+    }
+    for ( pl_i32_t j = 0; j <= lb; j++ ) {
+        d[ 0 ][ j + 1 ] = inf;
+        d[ 1 ][ j + 1 ] = j;
+    }
+
+    for ( pl_i32_t i = 1; i <= la; i++ ) {
+        db = 0;
+        for ( pl_i32_t j = 1; j <= lb; j++ ) {
+            k = da[ (pl_u8_t)b[ j - 1 ] ];
+            l = db;
+            if ( a[ i - 1 ] == b[ j - 1 ] ) {
+                cost = 0;
+                db = j;
             } else {
+                cost = 1;
+            }
 
-                /* Subcmd. */
+            /* Substitution, insertion, deletion, and transposition. */
+            v = d[ i ][ j ] + cost;
+            if ( d[ i + 1 ][ j ] + 1 < v ) {
+                v = d[ i + 1 ][ j ] + 1;
+            }
+            if ( d[ i ][ j + 1 ] + 1 < v ) {
+                v = d[ i ][ j + 1 ] + 1;
+            }
+            if ( d[ k ][ l ] + ( i - k - 1 ) + 1 + ( j - l - 1 ) < v ) {
+                v = d[ k ][ l ] + ( i - k - 1 ) + 1 + ( j - l - 1 );
+            }
+            d[ i + 1 ][ j + 1 ] = v;
+        }
+        da[ (pl_u8_t)a[ i - 1 ] ] = i;
+    }
 
-                /* Search for Subcmd. */
-                c = find_cmd_by_name( get_arg() );
-                o->given = pl_true;
-                c->given = pl_true;
-                next_arg();
-                *subcmd = c;
-                return 1;
+    return d[ la + 1 ][ lb + 1 ];
+}
+
+
+/**
+ * Add name to suggestion index. Duplicate names are skipped.
+ *
+ * @param cmd Command.
+ * @param name Name.
+ * @param subcmd Name is subcmd.
+ * @param idx Insertion order.
+ */
+static void suggest_add( como_cmd_t cmd, const char* name, pl_bool_t subcmd, pl_i64_t idx )
+{
+    como_bknode_t node, child, added;
+    pl_i64_t      dist = 0;
+
+    node = cmd->suggest;
+    while ( node ) {
+        dist = name_distance( node->name, name );
+        if ( dist == 0 ) {
+            return;
+        }
+        for ( child = node->child; child; child = child->sibling ) {
+            if ( child->dist == dist ) {
+                break;
             }
         }
+        if ( !child ) {
+            break;
+        }
+        node = child;
     }
 
-    if ( como_cmd->errors > 0 ) {
-        cmd->errors = como_cmd->errors;
+    added = mem_get_for_type( como_bknode_s );
+    added->name = name;
+    added->idx = idx;
+    added->subcmd = subcmd;
+    added->dist = dist;
+    added->child = NULL;
+    added->sibling = NULL;
+
+    if ( !node ) {
+        cmd->suggest = added;
+    } else {
+        added->sibling = node->child;
+        node->child = added;
+    }
+}
+
+
+/**
+ * Create suggestion index from visible option switches and subcmd
+ * names of command.
+ *
+ * @param cmd Command.
+ */
+static void suggest_create( como_cmd_t cmd )
+{
+    como_opt_t o;
+    pl_i64_t   idx = 0;
+
+    for ( pl_i64_t i = 0; i < cmd->optcnt; i++ ) {
+        o = cmd->opts[ i ];
+        if ( o->type == COMO_SUBCMD ) {
+            suggest_add( cmd, o->name, pl_true, idx++ );
+        } else if ( !( o->type & ( COMO_P_HIDDEN | COMO_P_DEFAULT ) ) ) {
+            if ( o->longopt ) {
+                suggest_add( cmd, o->longopt, pl_false, idx++ );
+            }
+            if ( o->shortopt ) {
+                suggest_add( cmd, o->shortopt, pl_false, idx++ );
+            }
+        }
+    }
+}
+
+
+/**
+ * Search suggestion index. Only subtrees within the distance limit of
+ * the query are visited (triangle inequality). Best matches are kept
+ * in order of distance and insertion.
+ *
+ * @param node Subtree root.
+ * @param name Query name.
+ * @param subcmd Search subcmd names (or option switches).
+ * @param limit Maximum distance.
+ * @param best Best matches.
+ * @param dist Distances of best matches.
+ * @param cnt Number of best matches.
+ */
+static void suggest_search( como_bknode_t node,
+                            const char*   name,
+                            pl_bool_t     subcmd,
+                            pl_i64_t      limit,
+                            como_bknode_t best[],
+                            pl_i64_t      dist[],
+                            pl_i64_t*     cnt )
+{
+    pl_i64_t d, i;
+
+    d = name_distance( node->name, name );
+
+    if ( d <= limit && node->subcmd == subcmd ) {
+        /* Insertion sort to best matches. */
+        i = *cnt;
+        while ( i > 0 &&
+                ( dist[ i - 1 ] > d || ( dist[ i - 1 ] == d && best[ i - 1 ]->idx > node->idx ) ) ) {
+            if ( i < COMO_SUGGEST_MAX ) {
+                best[ i ] = best[ i - 1 ];
+                dist[ i ] = dist[ i - 1 ];
+            }
+            i--;
+        }
+        if ( i < COMO_SUGGEST_MAX ) {
+            best[ i ] = node;
+            dist[ i ] = d;
+            if ( *cnt < COMO_SUGGEST_MAX ) {
+                ( *cnt )++;
+            }
+        }
+    }
+
+    for ( como_bknode_t child = node->child; child; child = child->sibling ) {
+        if ( child->dist >= d - limit && child->dist <= d + limit ) {
+            suggest_search( child, name, subcmd, limit, best, dist, cnt );
+        }
+    }
+}
+
+
+/**
+ * Suggest nearest names for unknown option or subcmd. Index is
+ * created on first use. Distance limit is third of the name length
+ * (without leading dashes), hence short switches are not suggested.
+ *
+ * @param cmd Command.
+ * @param name Unknown name.
+ * @param subcmd Suggest subcmd names (or option switches).
+ * @param buf Buffer for suggestion text (empty for none).
+ * @param size Buffer size.
+ */
+static void suggest( como_cmd_t cmd, const char* name, pl_bool_t subcmd, char* buf, pl_i64_t size )
+{
+    como_bknode_t best[ COMO_SUGGEST_MAX ];
+    pl_i64_t      dist[ COMO_SUGGEST_MAX ];
+    pl_i64_t      cnt = 0, limit, len;
+
+    buf[ 0 ] = 0;
+
+    if ( !cmd->suggest ) {
+        suggest_create( cmd );
+    }
+
+    limit = strlen( name + strspn( name, "-" ) ) / 3;
+    if ( !cmd->suggest || limit == 0 ) {
+        return;
+    }
+
+    suggest_search( cmd->suggest, name, subcmd, limit, best, dist, &cnt );
+
+    len = 0;
+    for ( pl_i64_t i = 0; i < cnt && len < size; i++ ) {
+        len += snprintf( &buf[ len ],
+                         size - len,
+                         "%s\"%s\"",
+                         i == 0 ? " (did you mean " : i == cnt - 1 ? " or " : ", ",
+                         best[ i ]->name );
+    }
+    if ( cnt > 0 && len < size ) {
+        snprintf( &buf[ len ], size - len, "?)" );
+    }
+}
+
+
+/**
+ * Get current argument from command line.
+ *
+ * @return Argument.
+ */
+static char* get_arg( void )
+{
+    return arg_vec[ arg_idx ];
+}
+
+
+/**
+ * Advance command line argument index.
+ */
+static void next_arg( void )
+{
+    arg_idx++;
+}
+
+
+/**
+ * Is current command line argument an option?
+ *
+ * @return True if is.
+ */
+static pl_bool_t is_opt( void )
+{
+    return arg_class[ arg_idx ] != COMO_ARG_POSITIONAL;
+}
+
+
+/**
+ * Release argument classes.
+ */
+static void args_release( void )
+{
+    if ( !fixed_mem ) {
+        free( arg_len );
+        free( arg_class );
+        free( arg_opt );
+        free( arg_value );
+        free( arg_valuecnt );
+    }
+    arg_len = NULL;
+    arg_class = NULL;
+    arg_opt = NULL;
+    arg_value = NULL;
+    arg_valuecnt = NULL;
+    arg_cap = 0;
+}
+
+
+/**
+ * Classify arguments from index onwards, and store their lengths.
+ * Tokens are scanned once, and parsing uses the classes instead of
+ * string compares. Parse fails if arrays can't be extended.
+ *
+ * @param from First argument to classify.
+ */
+static void args_classify( pl_i64_t from )
+{
+    pl_i64_t   cap;
+    pl_u8_t*   cls;
+    pl_u32_t*  len;
+    pl_u32_t*  val;
+    pl_u32_t*  valcnt;
+    como_opt_p opt;
+    char*      s;
+
+    if ( arg_cnt > arg_cap ) {
+        /* Earlier classes and occurrences are kept (incremental
+           parse). */
+        cap = ( 2 * arg_cap > arg_cnt ) ? 2 * arg_cap : arg_cnt;
+        if ( fixed_mem ) {
+            len = mem_get( cap * sizeof( pl_u32_t ) );
+            cls = mem_get( cap );
+            opt = mem_get( cap * sizeof( como_opt_t ) );
+            val = mem_get( cap * sizeof( pl_u32_t ) );
+            valcnt = mem_get( cap * sizeof( pl_u32_t ) );
+            if ( arg_cap > 0 ) {
+                memcpy( len, arg_len, arg_cap * sizeof( pl_u32_t ) );
+                memcpy( cls, arg_class, arg_cap );
+                memcpy( opt, arg_opt, arg_cap * sizeof( como_opt_t ) );
+                memcpy( val, arg_value, arg_cap * sizeof( pl_u32_t ) );
+                memcpy( valcnt, arg_valuecnt, arg_cap * sizeof( pl_u32_t ) );
+            }
+        } else {
+            /* Arrays that were extended are kept on failure, since the
+               old ones are released. */
+            len = realloc( arg_len, cap * sizeof( pl_u32_t ) );
+            arg_len = len ? len : arg_len;
+            cls = realloc( arg_class, cap );
+            arg_class = cls ? cls : arg_class;
+            opt = realloc( arg_opt, cap * sizeof( como_opt_t ) );
+            arg_opt = opt ? opt : arg_opt;
+            val = realloc( arg_value, cap * sizeof( pl_u32_t ) );
+            arg_value = val ? val : arg_value;
+            valcnt = realloc( arg_valuecnt, cap * sizeof( pl_u32_t ) );
+            arg_valuecnt = valcnt ? valcnt : arg_valuecnt;
+            if ( !len || !cls || !opt || !val || !valcnt ) {
+                como_fatal( "Out of memory for argument classes!\n" );
+                quit( EXIT_FAILURE );
+            }
+        }
+        arg_len = len;
+        arg_class = cls;
+        arg_opt = opt;
+        arg_value = val;
+        arg_valuecnt = valcnt;
+        arg_cap = cap;
+    }
+
+    for ( pl_i64_t i = from; i < arg_cnt; i++ ) {
+        s = arg_vec[ i ];
+        arg_opt[ i ] = NULL;
+        arg_len[ i ] = strlen( s );
+        if ( s[ 0 ] != '-' ) {
+            arg_class[ i ] = COMO_ARG_POSITIONAL;
+        } else if ( s[ 1 ] == '\0' ) {
+            arg_class[ i ] = COMO_ARG_DASH;
+        } else if ( s[ 1 ] != '-' ) {
+            arg_class[ i ] = COMO_ARG_SHORT;
+        } else if ( s[ 2 ] == '\0' ) {
+            arg_class[ i ] = COMO_ARG_TERMINATOR;
+        } else {
+            arg_class[ i ] = COMO_ARG_LONG;
+        }
+    }
+}
+
+
+/**
+ * Is option of switch type? Note that default type is also consided a
+ * switch.
+ *
+ * @param opt Option to check.
+ *
+ * @return True if is.
+ */
+static pl_bool_t has_switch_style_doc( como_opt_t opt )
+{
+    if ( ( ( opt->type & COMO_P_NONE ) && !( opt->type & COMO_P_MANY ) ) ||
+         ( opt->type & COMO_P_DEFAULT ) ) {
+        return pl_true;
+    } else {
+        return pl_false;
+    }
+}
+
+
+/**
+ * Record parse step to incremental parse journal (if active). If
+ * journal can't be extended, it is emptied (next parse starts over),
+ * and parse fails.
+ *
+ * @param kind Step kind (COMO_STEP_*).
+ * @param cmd Command.
+ * @param opt Option (or NULL).
+ */
+static void journal_add( pl_i64_t kind, como_cmd_t cmd, como_opt_t opt )
+{
+    parse_state_t ps = parse_journal;
+    parse_step_t  step, steps;
+    pl_i64_t      cap;
+
+    if ( !ps ) {
+        return;
+    }
+
+    if ( ps->stepcnt == ps->stepcap ) {
+        cap = ps->stepcap ? 2 * ps->stepcap : 64;
+        steps = realloc( ps->steps, cap * sizeof( parse_step_s ) );
+        if ( !steps ) {
+            como_fatal( "Out of memory for parse journal!\n" );
+            ps->stepcnt = 0;
+            quit( EXIT_FAILURE );
+        }
+        ps->steps = steps;
+        ps->stepcap = cap;
+    }
+
+    step = &ps->steps[ ps->stepcnt++ ];
+    step->kind = kind;
+    step->idx = arg_idx;
+    step->cmd = cmd;
+    step->opt = opt;
+}
+
+
+/**
+ * Record token boundary, i.e. a position where parsing can be resumed
+ * (see: como_parse()).
+ *
+ * @param cmd Command under parsing.
+ *
+ * @return True if arguments are left.
+ */
+static pl_bool_t next_token( como_cmd_t cmd )
+{
+    journal_add( COMO_STEP_TOKEN, cmd, NULL );
+    return get_arg() != NULL;
+}
+
+
+/**
+ * Increment given count of command.
+ *
+ * @param cmd Command.
+ */
+static void given_count( como_cmd_t cmd )
+{
+    cmd->givencnt++;
+    journal_add( COMO_STEP_COUNT, cmd, NULL );
+}
+
+
+/**
+ * Add value to option. Create value array if it doesn't exist.
+ *
+ * @param o Option.
+ * @param item Value.
+ */
+static void add_value( como_opt_t o, char* item )
+{
+    plcm_t storage = &o->value_store;
+
+    /* Lengths are updated after parsing. */
+    o->valuelen = NULL;
+    journal_add( COMO_STEP_VALUE, NULL, o );
+
+    if ( fixed_mem && value_mem == &como_mem ) {
+        fixed_store_ptr( storage, item, 4 );
+        return;
+    }
+
+    if ( plcm_data( storage ) == NULL ) {
+        plcm_use_plam( storage, value_mem, 4 * sizeof( char* ) );
+    }
+    plcm_resize( storage, storage->used + 1 );
+    plcm_store_ptr( storage, item );
+    plcm_terminate_ptr( storage );
+}
+
+
+/**
+ * Store option value lengths.
+ *
+ * @param o Option (with values).
+ * @param len Storage for lengths (valuecnt entries).
+ */
+static void opt_lengths( como_opt_t o, pl_size_t* len )
+{
+    for ( pl_i64_t i = 0; i < o->valuecnt; i++ ) {
+        len[ i ] = strlen( o->value[ i ] );
+    }
+    o->valuelen = len;
+}
+
+
+/**
+ * Return option values array.
+ *
+ * @param o Option.
+ *
+ * @return NULL terminated values.
+ */
+static char** opt_values( como_opt_t o )
+{
+    if ( plcm_data( &o->value_store ) ) {
+        return plcm_data( &o->value_store );
+    } else {
+        return como_no_values;
+    }
+}
+
+
+/**
+ * Record option occurrence.
+ *
+ * @param cmd Command.
+ * @param o Option.
+ * @param idx Argument index of occurrence.
+ * @param first Index of first value of occurrence.
+ */
+static void opt_occur( como_cmd_t cmd, como_opt_t o, pl_i64_t idx, pl_i64_t first )
+{
+    arg_opt[ idx ] = o;
+    arg_value[ idx ] = first;
+    arg_valuecnt[ idx ] = plcm_used_ptr( &o->value_store ) - first;
+    o->occurcnt++;
+
+    /* Occurrence arrays are updated after parsing. */
+    o->occur = NULL;
+    cmd->order = NULL;
+    journal_add( COMO_STEP_OCCUR, cmd, o );
+}
+
+
+/**
+ * Mark option given.
+ *
+ * @param cmd Command.
+ * @param o Option.
+ */
+static void opt_given( como_cmd_t cmd, como_opt_t o )
+{
+    void* target;
+
+    if ( !o->given ) {
+        journal_add( COMO_STEP_GIVEN, cmd, o );
+    }
+    o->given = pl_true;
+    bits_set( COMO_BITS_GIVEN( cmd ), o - cmd->opts[ 0 ] );
+
+    /* Update fields that depend on given status (or all values). */
+    if ( o->ext && o->ext->target ) {
+        target = o->ext->target;
+        switch ( o->ext->bind ) {
+            case COMO_BIND_BOOL:
+                *(_Bool*)target = 1;
+                break;
+            case COMO_BIND_INT:
+                if ( !plcm_data( &o->value_store ) ) {
+                    *(int*)target = ( o->type & COMO_P_COUNT ) ? o->occurcnt : 1;
+                }
+                break;
+            case COMO_BIND_I64:
+                if ( !plcm_data( &o->value_store ) ) {
+                    *(int64_t*)target = ( o->type & COMO_P_COUNT ) ? o->occurcnt : 1;
+                }
+                break;
+            case COMO_BIND_LIST:
+                *(char***)target = opt_values( o );
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+
+/**
+ * Convert value to bound result field type.
+ *
+ * @param o Option with bound field.
+ * @param arg Value.
+ * @param [out] target Converted value (field or scratch).
+ *
+ * @return True if value is valid for field type.
+ */
+static pl_bool_t bind_value( como_opt_t o, char* arg, void* target )
+{
+    char*     end;
+    long long ival;
+    double    dval;
+
+    errno = 0;
+
+    switch ( o->ext->bind ) {
+
+        case COMO_BIND_INT:
+        case COMO_BIND_I64:
+            ival = strtoll( arg, &end, 0 );
+            if ( end == arg || *end || errno ) {
+                return pl_false;
+            }
+            if ( o->ext->bind == COMO_BIND_INT ) {
+                if ( ival < INT32_MIN || ival > INT32_MAX ) {
+                    return pl_false;
+                }
+                *(int*)target = ival;
+            } else {
+                *(int64_t*)target = ival;
+            }
+            break;
+
+        case COMO_BIND_DOUBLE:
+            dval = strtod( arg, &end );
+            if ( end == arg || *end || errno ) {
+                return pl_false;
+            }
+            *(double*)target = dval;
+            break;
+
+        case COMO_BIND_STRING:
+            *(char**)target = arg;
+            break;
+
+        default:
+            break;
+    }
+
+    return pl_true;
+}
+
+
+/**
+ * Check current argument as value for option, if option has
+ * validator or bound result field. Validation and conversion are
+ * skipped if they are deferred to the worker pool.
+ *
+ * @param o Option receiving the value.
+ *
+ * @return True if valid.
+ */
+static pl_bool_t check_value( como_opt_t o )
+{
+    char*          arg = get_arg();
+    como_opt_ext_t ext = o->ext;
+
+    if ( ( ext && ext->valid && !valid_deferred && !ext->valid->fn( arg, ext->valid->arg ) ) ||
+         ( ext && ext->target && !valid_deferred && !bind_value( o, arg, ext->target ) ) ||
+         ( ( o->type & COMO_P_MAP ) && ( arg[ 0 ] == '=' || !strchr( arg, '=' ) ) ) ) {
+        como_error( "Invalid value \"%s\" for \"%s\" (arg %d)...",
+                    get_arg(),
+                    como_opt_id( o ),
+                    (int)( arg_idx + 1 ) );
+        return pl_false;
+    }
+
+    return pl_true;
+}
+
+
+/**
+ * Check option rules of command.
+ *
+ * @param cmd Command to check.
+ *
+ * @return True if all rules hold.
+ */
+static pl_bool_t check_rules( como_cmd_t cmd )
+{
+    pl_u64_t* given = COMO_BITS_GIVEN( cmd );
+    pl_i64_t  words = cmd->bitwords;
+    pl_i64_t  i;
+
+    for ( como_rule_t r = cmd->rules; r; r = r->next ) {
+
+        switch ( r->kind ) {
+
+            case COMO_RULE_KIND_REQUIRES:
+                if ( bits_test( given, r->first ) ) {
+                    i = bits_first( r->mask, given, pl_true, words );
+                    if ( i >= 0 ) {
+                        como_error( "Option \"%s\" requires \"%s\" for \"%s\"...",
+                                    como_opt_id( cmd->opts[ r->first ] ),
+                                    como_opt_id( cmd->opts[ i ] ),
+                                    cmd->longname );
+                        return pl_false;
+                    }
+                }
+                break;
+
+            case COMO_RULE_KIND_CONFLICTS:
+                if ( bits_test( given, r->first ) ) {
+                    i = bits_first( r->mask, given, pl_false, words );
+                    if ( i >= 0 ) {
+                        como_error( "Option \"%s\" conflicts with \"%s\" for \"%s\"...",
+                                    como_opt_id( cmd->opts[ r->first ] ),
+                                    como_opt_id( cmd->opts[ i ] ),
+                                    cmd->longname );
+                        return pl_false;
+                    }
+                }
+                break;
+
+            case COMO_RULE_KIND_AT_MOST_ONE:
+                if ( bits_count( r->mask, given, words ) > 1 ) {
+                    i = bits_first( r->mask, given, pl_false, words );
+                    como_error( "Only one of options allowed (\"%s\" given) for \"%s\"...",
+                                como_opt_id( cmd->opts[ i ] ),
+                                cmd->longname );
+                    return pl_false;
+                }
+                break;
+
+            case COMO_RULE_KIND_AT_LEAST_ONE:
+                if ( bits_first( r->mask, given, pl_false, words ) < 0 ) {
+                    i = bits_first( r->mask, r->mask, pl_false, words );
+                    como_error( "Option \"%s\" (or alternative) missing for \"%s\"...",
+                                como_opt_id( cmd->opts[ i ] ),
+                                cmd->longname );
+                    return pl_false;
+                }
+                break;
+        }
+    }
+
+    return pl_true;
+}
+
+
+/**
+ * Check for missing required arguments and option rules. Checking
+ * ends if exclusive argument is given. Checking continues with subcmd
+ * if encountered.
+ *
+ * @param cmd Command to check.
+ * @param errcmd Command that had missing options.
+ *
+ * @return True if no missing.
+ */
+static pl_bool_t check_constraints( como_cmd_t cmd, como_cmd_p errcmd )
+{
+    pl_u64_t*  given = COMO_BITS_GIVEN( cmd );
+    pl_i64_t   i;
+    pl_bool_t  subcheck;
+    como_cmd_t subcmd;
+
+    if ( !cmd->conf->check_missing ) {
+        return pl_true;
+    }
+
+    /* Missing are not checked if has exclusives. */
+    if ( bits_first( given, COMO_BITS_MUTEX( cmd ), pl_false, cmd->bitwords ) >= 0 ) {
+        return pl_true;
+    }
+
+    if ( !check_rules( cmd ) ) {
+        *errcmd = cmd;
+        return pl_false;
+    }
+
+    /* Check for missing options. */
+    i = bits_first( COMO_BITS_REQUIRED( cmd ), given, pl_true, cmd->bitwords );
+    if ( i >= 0 ) {
+        como_error( "Option \"%s\" missing for \"%s\"...", como_opt_id( cmd->opts[ i ] ), cmd->longname );
+        *errcmd = cmd;
+        return pl_false;
+    }
+
+    /* Check for missing subcmds. */
+    if ( !plcm_is_empty( &cmd->subcmds ) ) {
+        /* Has subcmds. */
+        if ( cmd->conf->subcheck ) {
+            subcheck = pl_true;
+        } else {
+            subcheck = pl_false;
+        }
+    } else {
+        subcheck = pl_false;
+    }
+
+    subcmd = como_cmd_given_subcmd( cmd );
+
+    if ( subcmd ) {
+        /* Go to level subcmd level. */
+        return check_constraints( subcmd, errcmd );
+    } else if ( subcheck ) {
+        como_error( "Subcommand required for \"%s\"...", cmd->name );
+        *errcmd = cmd;
+        return pl_false;
+    }
+
+    return pl_true;
+}
+
+
+/**
+ * Memory for option values and their derivatives (per request in
+ * server mode).
+ *
+ * @param size Size in bytes.
+ *
+ * @return Memory.
+ */
+static void* value_get( pl_u64_t size )
+{
+    if ( value_mem == &como_mem ) {
+        return mem_get( size );
+    } else {
+        return plam_get( value_mem, size );
+    }
+}
+
+
+/**
+ * Hash map key.
+ *
+ * @param key Key.
+ * @param len Key length.
+ *
+ * @return Hash.
+ */
+static pl_u64_t map_hash( const char* key, pl_i64_t len )
+{
+    pl_u64_t h = 14695981039346656037ULL;
+
+    for ( pl_i64_t i = 0; i < len; i++ ) {
+        h ^= (pl_u8_t)key[ i ];
+        h *= 1099511628211ULL;
+    }
+
+    return h ^ ( h >> 29 );
+}
+
+
+/**
+ * Find map slot for key, i.e. slot with key or empty slot.
+ *
+ * @param map Map.
+ * @param key Key.
+ * @param len Key length.
+ *
+ * @return Slot.
+ */
+static como_map_entry_t map_slot( como_map_t map, const char* key, pl_i64_t len )
+{
+    como_map_entry_t e;
+    pl_u64_t         i;
+
+    i = map_hash( key, len ) & map->mask;
+    for ( ;; ) {
+        e = &map->slots[ i ];
+        if ( !e->key || ( e->keylen == len && memcmp( e->key, key, len ) == 0 ) ) {
+            return e;
+        }
+        i = ( i + 1 ) & map->mask;
+    }
+}
+
+
+/**
+ * Return hash table size for map option values.
+ *
+ * @param cnt Value count.
+ *
+ * @return Slot count.
+ */
+static pl_u64_t map_size( pl_u64_t cnt )
+{
+    pl_u64_t size = 4;
+
+    while ( size < 2 * cnt ) {
+        size <<= 1;
+    }
+
+    return size;
+}
+
+
+/**
+ * Fill hash table of map option values. Arguments are split at "="
+ * without copying. Duplicate keys are resolved by "map_dup" policy.
+ *
+ * @param map Map with empty slots.
+ * @param o Map option.
+ * @param dup Duplicate key policy.
+ */
+static void map_fill( como_map_t map, como_opt_t o, pl_i64_t dup )
+{
+    como_map_entry_t e;
+    char**           value;
+    const char*      eq;
+
+    for ( value = plcm_data( &o->value_store ); *value; value++ ) {
+        eq = strchr( *value, '=' );
+        if ( !eq ) {
+            continue;
+        }
+        e = map_slot( map, *value, eq - *value );
+        if ( !e->key ) {
+            e->key = *value;
+            e->keylen = eq - *value;
+            e->value = eq + 1;
+            map->cnt++;
+        } else if ( dup == COMO_MAP_DUP_LAST ) {
+            e->value = eq + 1;
+        } else if ( dup == COMO_MAP_DUP_ERROR ) {
+            como_error( "Duplicate key \"%.*s\" for \"%s\"...",
+                        (int)e->keylen,
+                        e->key,
+                        como_opt_id( o ) );
+        }
+    }
+}
+
+
+/**
+ * Create hash table of map option values. Duplicate keys are resolved
+ * by "map_dup" configuration.
+ *
+ * @param cmd Command of option.
+ * @param o Map option.
+ */
+static void map_create( como_cmd_t cmd, como_opt_t o )
+{
+    como_map_t map;
+    pl_u64_t   size;
+
+    size = map_size( plcm_used_ptr( &o->value_store ) );
+
+    map = value_get( sizeof( como_map_s ) );
+    map->cnt = 0;
+    map->mask = size - 1;
+    map->slots = value_get( size * sizeof( como_map_entry_s ) );
+    memset( map->slots, 0, size * sizeof( como_map_entry_s ) );
+
+    map_fill( map, o, cmd->conf->map_dup );
+
+    o->ext->map = map;
+}
+
+
+/**
+ * Create hash tables for given map options of command.
+ *
+ * @param cmd Command.
+ */
+static void maps_create( como_cmd_t cmd )
+{
+    como_opt_t o;
+
+    for ( pl_i64_t i = 0; i < cmd->optcnt; i++ ) {
+        o = cmd->opts[ i ];
+        if ( ( o->type & COMO_P_MAP ) && plcm_used_ptr( &o->value_store ) > 0 ) {
+            map_create( cmd, o );
+        }
+    }
+}
+
+
+/**
+ * Parse command line and store given option values to options objects
+ * until subcmd is encountered or end.
+ *
+ * @param cmd Command to update.
+ * @param subcmd Command to update next.
+ *
+ * @retval 0 if all arguments have been parsed.
+ * @retval 1 if should continue with subcmd.
+ * @retval 2 if errors in parsing.
+ */
+static pl_i64_t parse_opts( como_cmd_t cmd, como_cmd_p subcmd )
+{
+    como_opt_t o;
+    como_cmd_t c;
+    pl_i64_t   start, first;
+    char       hint[ 256 ];
+
+    while ( next_token( cmd ) ) {
+
+        /* Option terminator?. */
+        if ( arg_class[ arg_idx ] == COMO_ARG_TERMINATOR ) {
+            COMO_PROBE3( token, arg_idx, get_arg(), COMO_TOKEN_TERMINATOR );
+            /*  Rest of the args do not belong to this program. */
+            next_arg();
+            query_cmd()->external = &( arg_vec[ arg_idx ] );
+            journal_add( COMO_STEP_EXTERNAL, query_cmd(), NULL );
+            break;
+        }
+
+        else if ( is_opt() ) {
+
+            /* Normal option. */
+            COMO_PROBE3( token, arg_idx, get_arg(), COMO_TOKEN_OPTION );
+
+            o = find_opt( cmd );
+
+            if ( !o ) {
+
+                /* Not found, might be default. */
+
+                if ( cmd->conf->check_invalid ) {
+                    /* Report missing. */
+                    suggest( cmd, get_arg(), pl_false, hint, sizeof( hint ) );
+                    como_error( "Unknown option \"%s\"%s...", get_arg(), hint );
+                    break;
+                } else {
+                    /* Default option. */
+                    o = find_opt_by_type( cmd, COMO_P_DEFAULT );
+                    if ( !o ) {
+                        como_error( "No default option specified to allow \"%s\"...", get_arg() );
+                        break;
+                    } else {
+                        if ( !check_value( o ) ) {
+                            break;
+                        }
+                        if ( !plcm_is_empty( &o->value_store ) ) {
+                            given_count( cmd );
+                        }
+                        first = plcm_used_ptr( &o->value_store );
+                        add_value( o, get_arg() );
+                        opt_occur( cmd, o, arg_idx, first );
+                    }
+                }
+            } else if ( o && ( ( o->type & COMO_P_ONE ) || ( o->type & COMO_P_MANY ) ) ) {
+
+                /* Option with arguments. */
+
+                start = arg_idx;
+                first = plcm_used_ptr( &o->value_store );
+                next_arg();
+
+                if ( ( get_arg() == NULL || is_opt() ) && !( o->type & COMO_P_NONE ) ) {
+                    como_error( "No argument given for \"%s\"...", como_opt_id( o ) );
+                    break;
+                } else {
+
+                    char* arg;
+
+                    if ( o->type & COMO_P_MANY ) {
+                        /* Get all arguments for multi-option. */
+                        while ( get_arg() && !is_opt() ) {
+                            if ( !check_value( o ) ) {
+                                break;
+                            }
+                            arg = get_arg();
+                            add_value( o, arg );
+                            next_arg();
+                        }
+                        if ( query_cmd()->errors > 0 ) {
+                            break;
+                        }
+                    } else {
+                        if ( o->given ) {
+                            como_error( "Too many arguments for option (\"%s\")...",
+                                        como_opt_id( o ) );
+                            break;
+                        }
+                        if ( get_arg() && !check_value( o ) ) {
+                            break;
+                        }
+                        arg = get_arg();
+                        add_value( o, arg );
+                        next_arg();
+                    }
+
+                    opt_occur( cmd, o, start, first );
+                    opt_given( cmd, o );
+                    given_count( cmd );
+                }
+            } else {
+
+                /* Switch option. */
+                opt_occur( cmd, o, arg_idx, plcm_used_ptr( &o->value_store ) );
+                opt_given( cmd, o );
+                given_count( cmd );
+                next_arg();
+            }
+        } else {
+
+            /* Subcmd or default. Check for Subcmd first. */
+            COMO_PROBE3( token, arg_idx, get_arg(), COMO_TOKEN_POSITIONAL );
+            o = find_opt( cmd );
+
+            if ( !o || o->type != COMO_SUBCMD ) {
+
+                /* Default argument. */
+
+                o = find_opt_by_type( cmd, COMO_P_DEFAULT );
+
+                if ( !o ) {
+                    if ( !plcm_is_empty( &cmd->subcmds ) ) {
+                        suggest( cmd, get_arg(), pl_true, hint, sizeof( hint ) );
+                        como_error( "Unknown subcmd: \"%s\"%s...", get_arg(), hint );
+                    } else {
+                        como_error( "No default option specified to allow \"%s\"...", get_arg() );
+                    }
+                    next_arg();
+                } else {
+                    if ( !check_value( o ) ) {
+                        break;
+                    }
+                    if ( !plcm_is_empty( &o->value_store ) ) {
+                        given_count( cmd );
+                    }
+                    first = plcm_used_ptr( &o->value_store );
+                    add_value( o, get_arg() );
+                    opt_occur( cmd, o, arg_idx, first );
+                    opt_given( cmd, o );
+                    next_arg();
+                }
+            } else {
+
+                /* Subcmd. */
+
+                /* Search for Subcmd. */
+                c = como_cmd_subcmd( cmd, get_arg() );
+                COMO_PROBE1( subcmd, c->longname );
+                opt_occur( cmd, o, arg_idx, 0 );
+                opt_given( cmd, o );
+                c->given = pl_true;
+                journal_add( COMO_STEP_SUBCMD, c, NULL );
+                next_arg();
+                *subcmd = c;
+                maps_create( cmd );
+                return 1;
+            }
+        }
+    }
+
+    maps_create( cmd );
+
+    if ( query_cmd()->errors > 0 ) {
+        cmd->errors = query_cmd()->errors;
         *subcmd = cmd;
         return 2;
     } else {
-        return 0;
+        return 0;
+    }
+}
+
+
+/**
+ * Create occurrence arrays of command options, and command
+ * occurrence order, from recorded occurrences.
+ *
+ * @param cmd Command.
+ */
+static void occurs_create( como_cmd_t cmd )
+{
+    como_occur_t occur, oc;
+    como_opt_t   o;
+    pl_i64_t     total, i;
+
+    total = 0;
+    for ( i = 0; i < cmd->optcnt; i++ ) {
+        total += cmd->opts[ i ]->occurcnt;
+    }
+    cmd->ordercnt = 0;
+    if ( total == 0 ) {
+        return;
+    }
+
+    /* Options have slices of one block. */
+    occur = value_get( total * sizeof( como_occur_s ) );
+    for ( i = 0; i < cmd->optcnt; i++ ) {
+        o = cmd->opts[ i ];
+        o->occur = ( o->occurcnt > 0 ) ? occur : NULL;
+        occur += o->occurcnt;
+        o->occurcnt = 0;
+    }
+
+    cmd->order = value_get( total * sizeof( como_occur_t ) );
+    for ( i = 0; i < arg_cnt; i++ ) {
+        o = arg_opt[ i ];
+        if ( !o || o < cmd->opts[ 0 ] || o >= cmd->opts[ 0 ] + cmd->optcnt ) {
+            continue;
+        }
+        oc = &o->occur[ o->occurcnt++ ];
+        oc->idx = i;
+        oc->opt = o - cmd->opts[ 0 ];
+        oc->value = arg_value[ i ];
+        oc->valuecnt = arg_valuecnt[ i ];
+        cmd->order[ cmd->ordercnt++ ] = oc;
+    }
+}
+
+
+/**
+ * Proxy for parse_opts. Checks for status after each subcmd and
+ * recurses further if no errors.
+ *
+ * @param cmd Command to parse.
+ * @param errcmd Command having errors.
+ *
+ * @return True if no errors.
+ */
+static pl_bool_t setup_and_parse( como_cmd_t cmd, como_cmd_p errcmd )
+{
+    pl_i64_t   ret;
+    como_cmd_t subcmd;
+    como_opt_t o;
+
+    cmd_materialize( cmd );
+
+    ret = parse_opts( cmd, &subcmd );
+
+    for ( pl_u64_t i = 0; i < cmd->optcnt; i++ ) {
+        /* Update the "value" pointers of options to refer the
+           collected option values. */
+        o = cmd->opts[ i ];
+        if ( o->type != COMO_SUBCMD ) {
+            if ( plcm_used_ptr( &o->value_store ) > 0 ) {
+                o->value = plcm_data( &o->value_store );
+            } else if ( ( o->type & COMO_P_MANY ) || ( o->type & COMO_P_DEFAULT ) ) {
+                o->value = como_no_values;
+            }
+        }
+        o->valuecnt = plcm_used_ptr( &o->value_store );
+        if ( o->valuecnt > 0 && !o->valuelen ) {
+            opt_lengths( o, value_get( o->valuecnt * sizeof( pl_size_t ) ) );
+        }
+    }
+
+    if ( !cmd->order ) {
+        occurs_create( cmd );
+    }
+
+    if ( ret == 0 ) {
+        /* done.*/
+        return pl_true;
+    } else if ( ret == 1 ) {
+        /* continue. */
+        return setup_and_parse( subcmd, errcmd );
+    } else if ( ret == 2 ) {
+        /* error. */
+        *errcmd = subcmd;
+        return pl_false;
+    } else {
+        return pl_true;
+    }
+}
+
+
+/**
+ * Has option validator or bound result field?
+ *
+ * @param o Option.
+ *
+ * @return True if has.
+ */
+static pl_bool_t opt_checked( como_opt_t o )
+{
+    return ( o->ext && ( o->ext->valid || o->ext->target ) );
+}
+
+
+/**
+ * Validate option values of a range of work items, and convert values
+ * of bound fields to scratch. Failures are collected to the worker.
+ *
+ * @param arg Worker.
+ *
+ * @return NULL.
+ */
+static void* valid_worker_run( void* arg )
+{
+    valid_worker_t w = arg;
+    valid_chunk_t  c;
+    valid_fail_t   f;
+    como_opt_ext_t ext;
+    char**         value;
+    pl_i64_t       ci, i;
+    union {
+        int64_t ival;
+        double  dval;
+        char*   sval;
+    } scratch;
+
+    for ( ;; ) {
+        ci = __atomic_fetch_add( w->next, 1, __ATOMIC_RELAXED );
+        if ( ci >= w->chunkcnt ) {
+            break;
+        }
+
+        c = &w->chunks[ ci ];
+        ext = c->opt->ext;
+        value = plcm_data( &c->opt->value_store );
+        for ( i = c->beg; i < c->end; i++ ) {
+            if ( ( ext->valid && !ext->valid->fn( value[ i ], ext->valid->arg ) ) ||
+                 ( ext->target && !bind_value( c->opt, value[ i ], &scratch ) ) ) {
+                f = plcm_get_ref_for_type( &w->fails, valid_fail_s );
+                f->cmd = c->cmd;
+                f->opt = c->opt;
+                f->value = value[ i ];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Compare failures by value address (for sorting).
+ */
+static int valid_fail_compare( const void* a, const void* b )
+{
+    const valid_fail_s* fa = a;
+    const valid_fail_s* fb = b;
+
+    if ( fa->value < fb->value ) {
+        return -1;
+    } else if ( fa->value > fb->value ) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+
+/**
+ * Compare argument to failure value address (for searching).
+ */
+static int valid_fail_search( const void* key, const void* item )
+{
+    const char*         arg = key;
+    const valid_fail_s* f = item;
+
+    if ( arg < f->value ) {
+        return -1;
+    } else if ( arg > f->value ) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+
+/**
+ * Validate option values for all given commands in the hierarchy, if
+ * validation is deferred from parsing. The values are split to chunks
+ * which are processed by a worker pool, if there are enough values.
+ * Values of bound fields are converted by the workers as well, and the
+ * last value of each option is stored to field, when all are valid.
+ *
+ * Failures are reported in command line order.
+ *
+ * @param cmd Main command.
+ * @param errcmd Command of first failure.
+ *
+ * @return True if all values are valid.
+ */
+static pl_bool_t check_values( como_cmd_t cmd, como_cmd_p errcmd )
+{
+    plcm_s         chunks;
+    valid_chunk_t  c;
+    valid_worker_s workers[ COMO_PAR_MAX_THREADS ];
+    pl_i64_t       threads, total, chunksize, next, i, j;
+    plcm_s         fails;
+    valid_fail_t   f;
+    pl_bool_t      ret = pl_true;
+
+    /* Count values to validate. */
+    total = 0;
+    for ( como_cmd_t c = cmd; c; c = como_cmd_given_subcmd( c ) ) {
+        for ( i = 0; i < c->optcnt; i++ ) {
+            if ( opt_checked( c->opts[ i ] ) ) {
+                total += plcm_used_ptr( &c->opts[ i ]->value_store );
+            }
+        }
+    }
+
+    if ( !valid_deferred || total == 0 ) {
+        return pl_true;
+    }
+
+    threads = cmd->conf->threads;
+    if ( threads > COMO_PAR_MAX_THREADS ) {
+        threads = COMO_PAR_MAX_THREADS;
+    }
+    if ( threads < 1 || total < COMO_PAR_MIN_VALUES ) {
+        threads = 1;
+    }
+
+    chunksize = total / ( threads * 4 );
+    if ( chunksize < COMO_PAR_MIN_CHUNK ) {
+        chunksize = COMO_PAR_MIN_CHUNK;
+    }
+
+    /* Split option values to chunks. */
+    plcm_empty( &chunks, 64 * sizeof( valid_chunk_s ) );
+    for ( como_cmd_t pc = cmd; pc; pc = como_cmd_given_subcmd( pc ) ) {
+        for ( i = 0; i < pc->optcnt; i++ ) {
+            como_opt_t o = pc->opts[ i ];
+            pl_i64_t   cnt;
+            if ( !opt_checked( o ) ) {
+                continue;
+            }
+            cnt = plcm_used_ptr( &o->value_store );
+            for ( j = 0; j < cnt; j += chunksize ) {
+                c = plcm_get_ref_for_type( &chunks, valid_chunk_s );
+                c->cmd = pc;
+                c->opt = o;
+                c->beg = j;
+                c->end = ( j + chunksize < cnt ) ? j + chunksize : cnt;
+            }
+        }
+    }
+
+    next = 0;
+    for ( i = 0; i < threads; i++ ) {
+        workers[ i ].chunks = plcm_data( &chunks );
+        workers[ i ].chunkcnt = chunks.used / sizeof( valid_chunk_s );
+        workers[ i ].next = &next;
+        plcm_empty( &workers[ i ].fails, 16 * sizeof( valid_fail_s ) );
+    }
+
+    /* Calling thread is the first worker. */
+    for ( i = 1; i < threads; i++ ) {
+        if ( pthread_create( &workers[ i ].thread, NULL, valid_worker_run, &workers[ i ] ) != 0 ) {
+            /* Continue with the threads available. */
+            for ( j = i; j < threads; j++ ) {
+                plcm_del( &workers[ j ].fails );
+            }
+            threads = i;
+            break;
+        }
+    }
+    valid_worker_run( &workers[ 0 ] );
+    for ( i = 1; i < threads; i++ ) {
+        pthread_join( workers[ i ].thread, NULL );
+    }
+
+    /* Merge failures and report them in command line order. */
+    plcm_empty( &fails, 16 * sizeof( valid_fail_s ) );
+    for ( i = 0; i < threads; i++ ) {
+        valid_fail_t wf = plcm_data( &workers[ i ].fails );
+        while ( (pl_t)wf < plcm_end( &workers[ i ].fails ) ) {
+            f = plcm_get_ref_for_type( &fails, valid_fail_s );
+            *f = *wf;
+            wf++;
+        }
+        plcm_del( &workers[ i ].fails );
+    }
+
+    if ( !plcm_is_empty( &fails ) ) {
+        pl_i64_t cnt = fails.used / sizeof( valid_fail_s );
+        qsort( plcm_data( &fails ), cnt, sizeof( valid_fail_s ), valid_fail_compare );
+        for ( i = 0; i < arg_cnt; i++ ) {
+            f = bsearch( arg_vec[ i ], plcm_data( &fails ), cnt, sizeof( valid_fail_s ),
+                         valid_fail_search );
+            if ( f ) {
+                como_error( "Invalid value \"%s\" for \"%s\" (arg %d)...",
+                            f->value,
+                            como_opt_id( f->opt ),
+                            (int)( i + 1 ) );
+                if ( ret ) {
+                    *errcmd = f->cmd;
+                    ret = pl_false;
+                }
+            }
+        }
+    }
+
+    /* Store bound fields in order (last value wins), as in parsing. */
+    if ( ret ) {
+        for ( como_cmd_t pc = cmd; pc; pc = como_cmd_given_subcmd( pc ) ) {
+            for ( i = 0; i < pc->optcnt; i++ ) {
+                como_opt_t o = pc->opts[ i ];
+                if ( o->ext && o->ext->target && plcm_used_ptr( &o->value_store ) > 0 ) {
+                    bind_value( o, ( (char**)plcm_end( &o->value_store ) )[ -1 ], o->ext->target );
+                }
+            }
+        }
+    }
+
+    plcm_del( &fails );
+    plcm_del( &chunks );
+
+    return ret;
+}
+
+
+/**
+ * Add option's command line formatting (usage) to str.
+ *
+ * @param [out] str String where command line is stored.
+ * @param [in] o Option to add.
+ */
+static void opt_cmdline( plcm_t str, como_opt_t o )
+{
+    if ( o->type & COMO_P_HIDDEN ) {
+        return;
+    }
+
+    if ( o->type & COMO_P_OPT ) {
+        if ( o->type & COMO_P_MUTEX ) {
+            plss_append( str, plsr_from_string( "{" ) );
+        } else {
+            plss_append( str, plsr_from_string( "[" ) );
+        }
+    }
+
+    plss_format_string( str, "%s", como_opt_id( o ) );
+
+    if ( !has_switch_style_doc( o ) ) {
+        plss_format_string( str, " <%s>", o->name );
+
+        if ( ( o->type & COMO_P_NONE ) && ( o->type & COMO_P_MANY ) ) {
+            plss_append( str, plsr_from_string( "*" ) );
+        } else if ( o->type & COMO_P_MANY ) {
+            plss_append( str, plsr_from_string( "+" ) );
+        }
+    }
+
+    if ( o->type & COMO_P_OPT ) {
+        if ( o->type & COMO_P_MUTEX ) {
+            plss_append( str, plsr_from_string( "}" ) );
+        } else {
+            plss_append( str, plsr_from_string( "]" ) );
+        }
+    }
+
+    if ( o->type & COMO_P_COUNT ) {
+        plss_append( str, plsr_from_string( "..." ) );
+    }
+}
+
+
+/**
+ * Add option documentation line.
+ *
+ * @param str String where document is stored.
+ * @param o Option to document.
+ * @param cmd Containing command (for configuration lookup).
+ */
+static void opt_doc( plcm_t str, como_opt_t o, como_cmd_t cmd )
+{
+    const char* format;
+    pl_i64_t    s, e;
+    pl_bool_t   first;
+
+    if ( o->type & COMO_P_HIDDEN ) {
+        return;
+    }
+
+    plcm_declare( format_str, 128 );
+    plss_format_string( &format_str, "  %%-%ds", cmd->conf->tab );
+    format = plss_string( &format_str );
+
+    /* Reformat doc str, so that newlines start a new line and tab
+     * chars align the start to previous line. */
+
+    first = pl_true;
+    s = 0;
+    e = 0;
+    for ( ;; ) {
+        if ( o->doc[ e ] == '\n' || o->doc[ e ] == 0 ) {
+            if ( first ) {
+                plss_format_string( str, format, como_opt_id( o ) );
+                plss_append( str,
+                             plsr_from_string_and_length( (char*)&( o->doc[ s ] ), ( e - s ) ) );
+                plss_append_char( str, '\n' );
+
+                if ( o->doc[ e ] == 0 ) {
+                    return;
+                } else {
+                    e++;
+                }
+
+                first = pl_false;
+            } else {
+                if ( o->doc[ s ] == '\t' ) {
+                    s++;
+                    plss_format_string( str, format, "" );
+                }
+                plss_append( str,
+                             plsr_from_string_and_length( (char*)&( o->doc[ s ] ), ( e - s ) ) );
+                plss_append_char( str, '\n' );
+
+                if ( o->doc[ e ] == 0 ) {
+                    return;
+                } else {
+                    e++;
+                }
+            }
+            s = e;
+
+        } else {
+            e++;
+        }
+    }
+}
+
+
+/**
+ * Length of string (zero for NULL).
+ *
+ * @param str String.
+ *
+ * @return Length.
+ */
+static pl_u64_t text_len( const char* str )
+{
+    return str ? strlen( str ) : 0;
+}
+
+
+/**
+ * Upper bound for usage text of option (command line and
+ * documentation).
+ *
+ * @param idlen Option id length.
+ * @param namelen Option name length.
+ * @param doc Option documentation.
+ * @param tab Documentation tab.
+ *
+ * @return Size in bytes.
+ */
+static pl_u64_t opt_usage_size( pl_u64_t idlen, pl_u64_t namelen, const char* doc, pl_u64_t tab )
+{
+    pl_u64_t lines = 1;
+
+    for ( const char* c = doc; c && *c; c++ ) {
+        if ( *c == '\n' ) {
+            lines++;
+        }
+    }
+
+    return idlen + namelen + 32 + lines * ( tab + idlen + 4 ) + text_len( doc );
+}
+
+
+/**
+ * Upper bound for usage text of command.
+ *
+ * @param cmd Command.
+ *
+ * @return Size in bytes.
+ */
+static pl_u64_t usage_size( como_cmd_t cmd )
+{
+    pl_u64_t size;
+
+    size = 256 + text_len( cmd->name ) + text_len( cmd->longname ) +
+           text_len( cmd->year ) + text_len( cmd->author ) +
+           text_len( cmd->conf->header ) + text_len( cmd->conf->footer );
+
+    for ( como_opt_p co = cmd->opts; *co; co++ ) {
+        size += opt_usage_size( text_len( como_opt_id( *co ) ),
+                                text_len( ( *co )->name ),
+                                ( *co )->doc,
+                                cmd->conf->tab );
+    }
+
+    return size;
+}
+
+
+/**
+ * Display help if help option is given for any of the commands in the
+ * hierarchy (recursion).
+ *
+ * @param cmd Command to search given help.
+ */
+static void usage_if_help( como_cmd_t cmd )
+{
+    como_cmd_t subcmd;
+    como_opt_t help;
+
+    help = find_opt_by_name( cmd, "help" );
+    if ( help && help->given ) {
+        como_cmd_usage( cmd );
+    } else if ( !plcm_is_empty( &cmd->subcmds ) && ( subcmd = como_cmd_given_subcmd( cmd ) ) ) {
+        usage_if_help( subcmd );
+    }
+}
+
+
+/**
+ * Export string to string area.
+ *
+ * @param ex Export state.
+ * @param str String (or NULL).
+ *
+ * @return Buffer offset (zero for NULL).
+ */
+static pl_u64_t export_str( export_t ex, const char* str )
+{
+    pl_u64_t pos, len;
+
+    if ( !str ) {
+        return 0;
+    }
+
+    len = strlen( str ) + 1;
+    pos = ex->strpos;
+    if ( ex->buf ) {
+        memcpy( ex->buf + pos, str, len );
+    }
+    ex->strpos += len;
+
+    return pos;
+}
+
+
+/**
+ * Export index entry.
+ *
+ * @param ex Export state.
+ * @param pos Index position.
+ * @param val Index value.
+ */
+static void export_idx( export_t ex, pl_u64_t pos, pl_u64_t val )
+{
+    if ( ex->buf ) {
+        ex->idx[ pos ] = val;
+    }
+}
+
+
+/**
+ * Export option.
+ *
+ * @param ex Export state.
+ * @param o Option.
+ * @param eo Exported option.
+ */
+static void export_opt( export_t ex, como_opt_t o, export_opt_t eo )
+{
+    char** value;
+
+    value = opt_values( o );
+
+    eo->type = o->type;
+    eo->name = export_str( ex, o->name );
+    eo->shortopt = export_str( ex, o->shortopt );
+    eo->doc = export_str( ex, o->doc );
+    eo->longopt = export_str( ex, o->longopt );
+    eo->given = o->given;
+    eo->hasvalue = ( o->value != NULL );
+    eo->valuecnt = plcm_used_ptr( &o->value_store );
+    eo->value = ex->idxcnt;
+    ex->idxcnt += eo->valuecnt;
+
+    for ( pl_u64_t i = 0; i < eo->valuecnt; i++ ) {
+        export_idx( ex, eo->value + i, export_str( ex, value[ i ] ) );
+    }
+
+    eo->occurcnt = o->occur ? o->occurcnt : 0;
+    eo->occur = ex->idxcnt;
+    ex->idxcnt += 2 * eo->occurcnt;
+    for ( pl_u64_t i = 0; i < eo->occurcnt; i++ ) {
+        export_idx( ex, eo->occur + 2 * i, ( (pl_u64_t)o->occur[ i ].opt << 32 ) | o->occur[ i ].idx );
+        export_idx( ex,
+                    eo->occur + 2 * i + 1,
+                    ( (pl_u64_t)o->occur[ i ].valuecnt << 32 ) | o->occur[ i ].value );
+    }
+}
+
+
+/**
+ * Export command and its subcmds (recursively). When sizing, counts
+ * and string area size are only accumulated.
+ *
+ * @param ex Export state.
+ * @param cmd Command.
+ * @param parent Parent command index (or -1).
+ *
+ * @return Command index.
+ */
+static pl_u64_t export_cmd( export_t ex, como_cmd_t cmd, pl_i64_t parent )
+{
+    export_cmd_s scratch_cmd;
+    export_opt_s scratch_opt;
+    export_cmd_t ec;
+    pl_u64_t     ci;
+    como_cmd_p   subcmd;
+    pl_u64_t     i;
+
+    ci = ex->cmdcnt++;
+    ec = ex->buf ? &ex->cmds[ ci ] : &scratch_cmd;
+
+    ec->name = export_str( ex, cmd->name );
+    ec->longname = export_str( ex, cmd->longname );
+    ec->author = export_str( ex, cmd->author );
+    ec->year = export_str( ex, cmd->year );
+    ec->header = export_str( ex, cmd->conf->header );
+    ec->footer = export_str( ex, cmd->conf->footer );
+    ec->parent = parent;
+    ec->givencnt = cmd->givencnt;
+    ec->errors = cmd->errors;
+    ec->tab = cmd->conf->tab;
+    ec->threads = cmd->conf->threads;
+    ec->map_dup = cmd->conf->map_dup;
+    ec->given = cmd->given;
+    ec->autohelp = cmd->conf->autohelp;
+    ec->subcheck = cmd->conf->subcheck;
+    ec->check_missing = cmd->conf->check_missing;
+    ec->check_invalid = cmd->conf->check_invalid;
+    ec->help_exit = cmd->conf->help_exit;
+
+    /* Options (only for created). */
+    ec->opt = ex->optcnt;
+    ec->optcnt = cmd->opts ? cmd->optcnt : 0;
+    ec->specsize = cmd->opts ? cmd->specsize : 0;
+    ex->optcnt += ec->optcnt;
+    for ( i = 0; i < ec->optcnt; i++ ) {
+        export_opt( ex, cmd->opts[ i ], ex->buf ? &ex->opts[ ec->opt + i ] : &scratch_opt );
+    }
+
+    /* Occurrence order. */
+    ec->ordercnt = cmd->order ? cmd->ordercnt : 0;
+    ec->order = ex->idxcnt;
+    ex->idxcnt += ec->ordercnt;
+    for ( i = 0; i < ec->ordercnt; i++ ) {
+        como_occur_t oc = cmd->order[ i ];
+        export_idx( ex,
+                    ec->order + i,
+                    ( (pl_u64_t)oc->opt << 32 ) | ( oc - cmd->opts[ oc->opt ]->occur ) );
+    }
+
+    /* Subcmds. */
+    ec->sub = ex->idxcnt;
+    ec->subcnt = plcm_used_ptr( &cmd->subcmds );
+    ex->idxcnt += ec->subcnt;
+    subcmd = plcm_data( &cmd->subcmds );
+    for ( i = 0; i < ec->subcnt; i++ ) {
+        export_idx( ex, ec->sub + i, export_cmd( ex, subcmd[ i ], ci ) );
+    }
+
+    return ci;
+}
+
+
+/**
+ * Export external args.
+ *
+ * @param ex Export state.
+ * @param cmd Main command.
+ * @param hdr Header for external args info.
+ */
+static void export_external( export_t ex, como_cmd_t cmd, export_hdr_t hdr )
+{
+    char** ext = cmd->external;
+
+    hdr->hasext = ( ext != NULL );
+    hdr->external = ex->idxcnt;
+    hdr->extcnt = 0;
+
+    if ( ext ) {
+        while ( ext[ hdr->extcnt ] ) {
+            hdr->extcnt++;
+        }
+        ex->idxcnt += hdr->extcnt;
+        for ( pl_u64_t i = 0; i < hdr->extcnt; i++ ) {
+            export_idx( ex, hdr->external + i, export_str( ex, ext[ i ] ) );
+        }
+    }
+}
+
+
+/**
+ * Export parse results (see: como_export()), with spec cache key.
+ *
+ * @param cmd Main command.
+ * @param buf Buffer (or NULL).
+ * @param size Buffer size.
+ * @param key Spec cache key (or NULL).
+ *
+ * @return Required buffer size.
+ */
+static pl_i64_t export_results( como_cmd_t cmd, void* buf, pl_i64_t size, const char* key )
+{
+    export_s     ex;
+    export_hdr_s scratch_hdr;
+    export_hdr_t hdr;
+    pl_u64_t     total;
+
+    /* Sizing pass. */
+    memset( &ex, 0, sizeof( ex ) );
+    export_cmd( &ex, cmd, -1 );
+    export_external( &ex, cmd, &scratch_hdr );
+    export_str( &ex, key );
+
+    total = sizeof( export_hdr_s ) + ex.cmdcnt * sizeof( export_cmd_s ) +
+            ex.optcnt * sizeof( export_opt_s ) + ex.idxcnt * sizeof( pl_u64_t ) + ex.strpos;
+
+    if ( !buf || (pl_u64_t)size < total ) {
+        return total;
+    }
+
+    /* Writing pass. */
+    hdr = buf;
+    hdr->magic = COMO_EXPORT_MAGIC;
+    hdr->version = COMO_EXPORT_VERSION;
+    hdr->size = total;
+    hdr->cmdcnt = ex.cmdcnt;
+    hdr->optcnt = ex.optcnt;
+    hdr->idxcnt = ex.idxcnt;
+
+    ex.buf = buf;
+    ex.cmds = (export_cmd_t)( ex.buf + sizeof( export_hdr_s ) );
+    ex.opts = (export_opt_t)( ex.cmds + hdr->cmdcnt );
+    ex.idx = (pl_u64_t*)( ex.opts + hdr->optcnt );
+    ex.strpos = (char*)( ex.idx + hdr->idxcnt ) - ex.buf;
+    ex.cmdcnt = 0;
+    ex.optcnt = 0;
+    ex.idxcnt = 0;
+
+    export_cmd( &ex, cmd, -1 );
+    export_external( &ex, cmd, hdr );
+    hdr->key = export_str( &ex, key );
+
+    return total;
+}
+
+
+/**
+ * Reserve memory from block.
+ *
+ * @param [in,out] pos Block position.
+ * @param size Size to reserve.
+ *
+ * @return Reserved memory.
+ */
+static void* import_carve( char** pos, pl_u64_t size )
+{
+    void* ret = *pos;
+    *pos += ( size + 7 ) & ~7ULL;
+    return ret;
+}
+
+
+/**
+ * Check that count of entries from start fits in limit.
+ *
+ * @param start First entry.
+ * @param cnt Entry count.
+ * @param limit Entry limit.
+ *
+ * @return True if fits.
+ */
+static pl_bool_t import_range( pl_u64_t start, pl_u64_t cnt, pl_u64_t limit )
+{
+    return start <= limit && cnt <= limit - start;
+}
+
+
+/**
+ * Validate export buffer: header, counts, indices, and string offsets
+ * are checked against the buffer, so that imported views stay within
+ * the buffer.
+ *
+ * @param buf Buffer.
+ * @param size Buffer size.
+ *
+ * @return True if valid.
+ */
+static pl_bool_t import_valid( const void* buf, pl_i64_t size )
+{
+    const export_hdr_s* hdr = buf;
+    const char*         base = buf;
+    export_cmd_t        ecmds, ec;
+    export_opt_t        eopts, eo;
+    pl_u64_t*           idx;
+    pl_u64_t            rest, strbase, i, j, k;
+
+#define IMPORT_STR_VALID( off ) \
+    ( ( off ) == 0 || ( ( off ) >= strbase && ( off ) < hdr->size ) )
+
+    if ( size < (pl_i64_t)sizeof( export_hdr_s ) || hdr->magic != COMO_EXPORT_MAGIC ||
+         hdr->version != COMO_EXPORT_VERSION || hdr->size > (pl_u64_t)size ||
+         hdr->size < sizeof( export_hdr_s ) ) {
+        return pl_false;
+    }
+
+    /* Tables and string area. */
+    rest = hdr->size - sizeof( export_hdr_s );
+    if ( hdr->cmdcnt == 0 || hdr->cmdcnt > rest / sizeof( export_cmd_s ) ) {
+        return pl_false;
+    }
+    rest -= hdr->cmdcnt * sizeof( export_cmd_s );
+    if ( hdr->optcnt > rest / sizeof( export_opt_s ) ) {
+        return pl_false;
+    }
+    rest -= hdr->optcnt * sizeof( export_opt_s );
+    if ( hdr->idxcnt > rest / sizeof( pl_u64_t ) ) {
+        return pl_false;
+    }
+    rest -= hdr->idxcnt * sizeof( pl_u64_t );
+    strbase = hdr->size - rest;
+
+    /* Strings are terminated within the buffer. */
+    if ( rest > 0 && base[ hdr->size - 1 ] != '\0' ) {
+        return pl_false;
+    }
+
+    ecmds = (export_cmd_t)( base + sizeof( export_hdr_s ) );
+    eopts = (export_opt_t)( ecmds + hdr->cmdcnt );
+    idx = (pl_u64_t*)( eopts + hdr->optcnt );
+
+    for ( i = 0; i < hdr->optcnt; i++ ) {
+        eo = &eopts[ i ];
+        if ( !IMPORT_STR_VALID( eo->name ) || !IMPORT_STR_VALID( eo->shortopt ) ||
+             !IMPORT_STR_VALID( eo->doc ) || !IMPORT_STR_VALID( eo->longopt ) ||
+             !import_range( eo->value, eo->valuecnt, hdr->idxcnt ) ||
+             eo->occurcnt > hdr->idxcnt / 2 ||
+             !import_range( eo->occur, 2 * eo->occurcnt, hdr->idxcnt ) ) {
+            return pl_false;
+        }
+        for ( j = 0; j < eo->valuecnt; j++ ) {
+            if ( !IMPORT_STR_VALID( idx[ eo->value + j ] ) ) {
+                return pl_false;
+            }
+        }
+        for ( j = 0; j < eo->occurcnt; j++ ) {
+            k = idx[ eo->occur + 2 * j + 1 ];
+            if ( !import_range( (pl_u32_t)k, k >> 32, eo->valuecnt ) ) {
+                return pl_false;
+            }
+        }
+    }
+
+    /* Commands are in depth first order, parent before subcmds. */
+    for ( i = 0; i < hdr->cmdcnt; i++ ) {
+        ec = &ecmds[ i ];
+        if ( !IMPORT_STR_VALID( ec->name ) || !IMPORT_STR_VALID( ec->longname ) ||
+             !IMPORT_STR_VALID( ec->author ) || !IMPORT_STR_VALID( ec->year ) ||
+             !IMPORT_STR_VALID( ec->header ) || !IMPORT_STR_VALID( ec->footer ) ||
+             ( i == 0 ? ec->parent != -1 : ( ec->parent < 0 || (pl_u64_t)ec->parent >= i ) ) ||
+             !import_range( ec->opt, ec->optcnt, hdr->optcnt ) || ec->specsize > ec->optcnt ||
+             !import_range( ec->order, ec->ordercnt, hdr->idxcnt ) ||
+             !import_range( ec->sub, ec->subcnt, hdr->idxcnt ) ) {
+            return pl_false;
+        }
+        for ( j = 0; j < ec->optcnt; j++ ) {
+            eo = &eopts[ ec->opt + j ];
+            for ( k = 0; k < eo->occurcnt; k++ ) {
+                if ( ( idx[ eo->occur + 2 * k ] >> 32 ) >= ec->optcnt ) {
+                    return pl_false;
+                }
+            }
+        }
+        for ( j = 0; j < ec->ordercnt; j++ ) {
+            k = idx[ ec->order + j ] >> 32;
+            if ( k >= ec->optcnt ||
+                 (pl_u32_t)idx[ ec->order + j ] >= eopts[ ec->opt + k ].occurcnt ) {
+                return pl_false;
+            }
+        }
+        for ( j = 0; j < ec->subcnt; j++ ) {
+            k = idx[ ec->sub + j ];
+            if ( k <= i || k >= hdr->cmdcnt || ecmds[ k ].parent != (pl_i64_t)i ) {
+                return pl_false;
+            }
+        }
+    }
+
+    /* External args. */
+    if ( !IMPORT_STR_VALID( hdr->key ) ||
+         !import_range( hdr->external, hdr->extcnt, hdr->idxcnt ) ) {
+        return pl_false;
+    }
+    for ( j = 0; j < hdr->extcnt; j++ ) {
+        if ( !IMPORT_STR_VALID( idx[ hdr->external + j ] ) ) {
+            return pl_false;
+        }
+    }
+
+#undef IMPORT_STR_VALID
+
+    return pl_true;
+}
+
+
+/**
+ * Return memory size for imported views and pointer arrays of export
+ * buffer.
+ *
+ * @param buf Buffer.
+ * @param size Buffer size.
+ *
+ * @return Size (or 0 if buffer is invalid).
+ */
+static pl_u64_t import_size( const void* buf, pl_i64_t size )
+{
+    const export_hdr_s* hdr = buf;
+    export_cmd_t        ecmds;
+    export_opt_t        eopts;
+    pl_u64_t            total, i;
+
+    if ( !import_valid( buf, size ) ) {
+        return 0;
+    }
+
+    ecmds = (export_cmd_t)( (char*)buf + sizeof( export_hdr_s ) );
+    eopts = (export_opt_t)( ecmds + hdr->cmdcnt );
+
+    total = hdr->cmdcnt * ( sizeof( como_cmd_s ) + sizeof( como_config_s ) ) +
+            hdr->optcnt * sizeof( como_opt_s ) + ( hdr->extcnt + 1 ) * sizeof( char* );
+    for ( i = 0; i < hdr->cmdcnt; i++ ) {
+        total += ( ecmds[ i ].optcnt + 1 + ecmds[ i ].subcnt + 1 + ecmds[ i ].ordercnt ) *
+                     sizeof( char* ) +
+                 keys_size( ecmds[ i ].optcnt );
+    }
+    for ( i = 0; i < hdr->optcnt; i++ ) {
+        total += ( eopts[ i ].valuecnt + 1 ) * sizeof( char* ) +
+                 eopts[ i ].valuecnt * sizeof( pl_size_t ) +
+                 eopts[ i ].occurcnt * sizeof( como_occur_s );
+        if ( ( eopts[ i ].type & COMO_P_MAP ) && eopts[ i ].valuecnt > 0 ) {
+            total += sizeof( como_opt_ext_s ) + sizeof( como_map_s ) +
+                     map_size( eopts[ i ].valuecnt ) * sizeof( como_map_entry_s );
+        }
+    }
+
+    return total;
+}
+
+
+/**
+ * Create hash table of imported map option values. Duplicate keys
+ * were reported in parsing, hence only first or last is selected.
+ *
+ * @param o Imported option.
+ * @param [in,out] pos Block position.
+ * @param dup Duplicate key policy.
+ */
+static void import_map( como_opt_t o, char** pos, pl_i64_t dup )
+{
+    como_map_t map;
+    pl_u64_t   size;
+
+    /* Once per option, even if shared by commands. */
+    if ( !( o->type & COMO_P_MAP ) || o->valuecnt == 0 || o->ext ) {
+        return;
+    }
+
+    o->ext = import_carve( pos, sizeof( como_opt_ext_s ) );
+    memset( o->ext, 0, sizeof( como_opt_ext_s ) );
+    size = map_size( o->valuecnt );
+    map = import_carve( pos, sizeof( como_map_s ) );
+    map->cnt = 0;
+    map->mask = size - 1;
+    map->slots = import_carve( pos, size * sizeof( como_map_entry_s ) );
+    memset( map->slots, 0, size * sizeof( como_map_entry_s ) );
+
+    map_fill( map, o, dup == COMO_MAP_DUP_LAST ? COMO_MAP_DUP_LAST : COMO_MAP_DUP_FIRST );
+
+    o->ext->map = map;
+}
+
+
+/**
+ * Import parse results from export buffer (see: como_import()).
+ *
+ * @param buf Buffer.
+ * @param size Buffer size.
+ * @param mem Memory for views (see: import_size()), or NULL for heap.
+ *
+ * @return Main command (or NULL if buffer is invalid).
+ */
+static como_cmd_t import_results( const void* buf, pl_i64_t size, void* mem )
+{
+    const export_hdr_s* hdr = buf;
+    char*               base = (char*)buf;
+    export_cmd_t        ecmds;
+    export_opt_t        eopts;
+    pl_u64_t*           idx;
+    pl_u64_t            total, i, j;
+    char*               pos;
+    como_cmd_t          cmds, c;
+    como_config_t       confs;
+    como_opt_t          opts, o;
+    char**              arr;
+
+#define IMPORT_STR( off ) ( ( off ) ? base + ( off ) : NULL )
+
+    if ( !mem ) {
+        total = import_size( buf, size );
+        if ( total == 0 ) {
+            return NULL;
+        }
+        mem = malloc( total );
+        if ( !mem ) {
+            return NULL;
+        }
+    }
+
+    ecmds = (export_cmd_t)( base + sizeof( export_hdr_s ) );
+    eopts = (export_opt_t)( ecmds + hdr->cmdcnt );
+    idx = (pl_u64_t*)( eopts + hdr->optcnt );
+
+    /* Commands and configs first (see: como_freeze()). */
+    pos = mem;
+    cmds = import_carve( &pos, hdr->cmdcnt * sizeof( como_cmd_s ) );
+    confs = import_carve( &pos, hdr->cmdcnt * sizeof( como_config_s ) );
+    opts = import_carve( &pos, hdr->optcnt * sizeof( como_opt_s ) );
+
+    /* Options. */
+    for ( i = 0; i < hdr->optcnt; i++ ) {
+        export_opt_t eo = &eopts[ i ];
+        o = &opts[ i ];
+        o->type = eo->type;
+        o->name = IMPORT_STR( eo->name );
+        o->shortopt = IMPORT_STR( eo->shortopt );
+        o->doc = IMPORT_STR( eo->doc );
+        o->longopt = IMPORT_STR( eo->longopt );
+        o->given = eo->given;
+        o->ext = NULL;
+        o->valuecnt = eo->valuecnt;
+        memset( &o->value_store, 0, sizeof( plcm_s ) );
+        if ( eo->valuecnt > 0 ) {
+            arr = import_carve( &pos, ( eo->valuecnt + 1 ) * sizeof( char* ) );
+            plcm_use( &o->value_store, arr, ( eo->valuecnt + 1 ) * sizeof( char* ) );
+            for ( j = 0; j < eo->valuecnt; j++ ) {
+                plcm_store_ptr( &o->value_store, IMPORT_STR( idx[ eo->value + j ] ) );
+            }
+            plcm_terminate_ptr( &o->value_store );
+            o->value = plcm_data( &o->value_store );
+            opt_lengths( o, import_carve( &pos, eo->valuecnt * sizeof( pl_size_t ) ) );
+        } else {
+            o->value = eo->hasvalue ? como_no_values : NULL;
+            o->valuelen = NULL;
+        }
+        o->occurcnt = eo->occurcnt;
+        o->occur = NULL;
+        if ( eo->occurcnt > 0 ) {
+            o->occur = import_carve( &pos, eo->occurcnt * sizeof( como_occur_s ) );
+            for ( j = 0; j < eo->occurcnt; j++ ) {
+                o->occur[ j ].idx = (pl_u32_t)idx[ eo->occur + 2 * j ];
+                o->occur[ j ].opt = idx[ eo->occur + 2 * j ] >> 32;
+                o->occur[ j ].value = (pl_u32_t)idx[ eo->occur + 2 * j + 1 ];
+                o->occur[ j ].valuecnt = idx[ eo->occur + 2 * j + 1 ] >> 32;
+            }
+        }
+    }
+
+    /* Commands. */
+    for ( i = 0; i < hdr->cmdcnt; i++ ) {
+        export_cmd_t ec = &ecmds[ i ];
+        c = &cmds[ i ];
+        c->name = IMPORT_STR( ec->name );
+        c->longname = IMPORT_STR( ec->longname );
+        c->author = IMPORT_STR( ec->author );
+        c->year = IMPORT_STR( ec->year );
+        c->parent = ( ec->parent >= 0 ) ? &cmds[ ec->parent ] : NULL;
+        c->external = NULL;
+        c->given = ec->given;
+        c->givencnt = ec->givencnt;
+        c->ordercnt = ec->ordercnt;
+        c->order = NULL;
+        if ( ec->ordercnt > 0 ) {
+            c->order = import_carve( &pos, ec->ordercnt * sizeof( como_occur_t ) );
+            for ( j = 0; j < ec->ordercnt; j++ ) {
+                c->order[ j ] =
+                    &opts[ ec->opt + ( idx[ ec->order + j ] >> 32 ) ]
+                         .occur[ (pl_u32_t)idx[ ec->order + j ] ];
+            }
+        }
+        c->errors = ec->errors;
+        c->spec = NULL;
+        c->specsize = ec->specsize;
+        c->image = NULL;
+        c->plugin = NULL;
+        c->plugin_handle = NULL;
+        c->bits = NULL;
+        c->bitwords = 0;
+        c->rules = NULL;
+        c->suggest = NULL;
+        c->handler = NULL;
+        c->handler_arg = NULL;
+
+        c->conf = &confs[ i ];
+        c->conf->autohelp = ec->autohelp;
+        c->conf->header = IMPORT_STR( ec->header );
+        c->conf->footer = IMPORT_STR( ec->footer );
+        c->conf->subcheck = ec->subcheck;
+        c->conf->check_missing = ec->check_missing;
+        c->conf->check_invalid = ec->check_invalid;
+        c->conf->tab = ec->tab;
+        c->conf->help_exit = ec->help_exit;
+        c->conf->threads = ec->threads;
+        c->conf->map_dup = ec->map_dup;
+        c->conf->refcnt = 1;
+
+        c->optcnt = ec->optcnt;
+        c->opts = import_carve( &pos, ( ec->optcnt + 1 ) * sizeof( como_opt_t ) );
+        for ( j = 0; j < ec->optcnt; j++ ) {
+            c->opts[ j ] = &opts[ ec->opt + j ];
+            import_map( c->opts[ j ], &pos, ec->map_dup );
+        }
+        c->opts[ j ] = NULL;
+        keys_setup( c, import_carve( &pos, keys_size( ec->optcnt ) ) );
+
+        memset( &c->subcmds, 0, sizeof( plcm_s ) );
+        if ( ec->subcnt > 0 ) {
+            arr = import_carve( &pos, ( ec->subcnt + 1 ) * sizeof( como_cmd_t ) );
+            plcm_use( &c->subcmds, arr, ( ec->subcnt + 1 ) * sizeof( como_cmd_t ) );
+            for ( j = 0; j < ec->subcnt; j++ ) {
+                plcm_store_ptr( &c->subcmds, &cmds[ idx[ ec->sub + j ] ] );
+            }
+        }
+    }
+
+    /* External args (main command). */
+    if ( hdr->hasext ) {
+        arr = import_carve( &pos, ( hdr->extcnt + 1 ) * sizeof( char* ) );
+        for ( j = 0; j < hdr->extcnt; j++ ) {
+            arr[ j ] = IMPORT_STR( idx[ hdr->external + j ] );
+        }
+        arr[ j ] = NULL;
+        cmds[ 0 ].external = arr;
+    }
+
+#undef IMPORT_STR
+
+    return cmds;
+}
+
+
+static void quit( int status )
+{
+    if ( serve_active ) {
+        /* Request is finished, but server continues. */
+        serve_status = status;
+        longjmp( serve_jmp, 1 );
+    }
+
+    como_end();
+    exit( status );
+}
+
+
+/**
+ * Reset parse results of all commands for reparsing.
+ */
+static void results_reset( void )
+{
+    como_cmd_p cmd;
+    como_cmd_t c;
+    como_opt_t o;
+
+    cmd = plcm_data( &cmd_list );
+    while ( (pl_t)cmd < plcm_end( &cmd_list ) ) {
+        c = *cmd;
+        c->given = pl_false;
+        c->givencnt = 0;
+        c->order = NULL;
+        c->ordercnt = 0;
+        c->errors = 0;
+        c->external = NULL;
+        if ( c->opts ) {
+            for ( pl_i64_t i = 0; i < c->optcnt; i++ ) {
+                o = c->opts[ i ];
+                if ( plcm_data( &o->value_store ) ) {
+                    plcm_del( &o->value_store );
+                }
+                memset( &o->value_store, 0, sizeof( plcm_s ) );
+                o->value = NULL;
+                o->valuelen = NULL;
+                o->valuecnt = 0;
+                o->given = pl_false;
+                o->occur = NULL;
+                o->occurcnt = 0;
+                if ( o->ext ) {
+                    o->ext->map = NULL;
+                }
+            }
+            memset( COMO_BITS_GIVEN( c ), 0, c->bitwords * sizeof( pl_u64_t ) );
+        }
+        cmd++;
+    }
+}
+
+
+/**
+ * Read exactly size bytes.
+ *
+ * @param fd File descriptor.
+ * @param buf Buffer.
+ * @param size Size.
+ *
+ * @return True if successful.
+ */
+static pl_bool_t read_full( int fd, void* buf, pl_u64_t size )
+{
+    ssize_t ret;
+
+    while ( size > 0 ) {
+        ret = read( fd, buf, size );
+        if ( ret < 0 && errno == EINTR ) {
+            continue;
+        }
+        if ( ret <= 0 ) {
+            return pl_false;
+        }
+        buf = (char*)buf + ret;
+        size -= ret;
+    }
+
+    return pl_true;
+}
+
+
+/**
+ * Write exactly size bytes.
+ *
+ * @param fd File descriptor.
+ * @param buf Buffer.
+ * @param size Size.
+ *
+ * @return True if successful.
+ */
+static pl_bool_t write_full( int fd, const void* buf, pl_u64_t size )
+{
+    ssize_t ret;
+
+    while ( size > 0 ) {
+        ret = send( fd, buf, size, MSG_NOSIGNAL );
+        if ( ret < 0 && errno == EINTR ) {
+            continue;
+        }
+        if ( ret <= 0 ) {
+            return pl_false;
+        }
+        buf = (const char*)buf + ret;
+        size -= ret;
+    }
+
+    return pl_true;
+}
+
+
+/**
+ * Parse arguments from command (at current argument) and check the
+ * results. Errors are reported with usage, and quit.
+ *
+ * @param cmd Command to parse.
+ */
+static void finish_from( como_cmd_t cmd )
+{
+    pl_bool_t  success;
+    como_cmd_t root, errcmd;
+
+    /* Parse all arguments and fill information to options. */
+
+    if ( local_main ) {
+        /* Private results, arguments are set by caller. */
+        root = local_main;
+    } else {
+        root = como_main;
+        como_cmd = como_main;
+        arg_cnt = como_argc;
+        arg_vec = como_argv;
+    }
+
+    /* Worker pool allocates from heap, hence not in zero-heap mode,
+       and validates (and converts) all values, hence not in
+       incremental parse. */
+    valid_deferred = ( root->conf->threads > 1 && !fixed_mem && !parse_journal );
+
+    COMO_PROBE1( parse__start, arg_cnt );
+
+    args_classify( arg_idx );
+
+    success = setup_and_parse( cmd, &errcmd ) && check_values( root, &errcmd ) &&
+              check_constraints( root, &errcmd );
+
+    COMO_PROBE1( parse__end, success );
+
+    if ( !success ) {
+        como_cmd_usage( errcmd );
+        quit( EXIT_FAILURE );
+    } else {
+        usage_if_help( root );
+    }
+}
+
+
+/**
+ * Parse from command without exiting on errors.
+ *
+ * @param cmd Command to parse.
+ * @param [out] status Exit status (if parsing ended).
+ *
+ * @return True if parsed successfully.
+ */
+static pl_bool_t request_finish( como_cmd_t cmd, int* status )
+{
+    if ( setjmp( serve_jmp ) ) {
+        serve_active = pl_false;
+        *status = serve_status;
+        return pl_false;
+    }
+
+    serve_active = pl_true;
+    finish_from( cmd );
+    serve_active = pl_false;
+
+    return pl_true;
+}
+
+
+/**
+ * Parse request arguments without exiting on errors.
+ *
+ * @param argc Argument count.
+ * @param argv Arguments.
+ * @param [out] status Exit status (if parsing ended).
+ *
+ * @return True if parsed successfully.
+ */
+static pl_bool_t request_parse( pl_i64_t argc, char** argv, int* status )
+{
+    como_argc = argc - 1;
+    como_argv = argv + 1;
+    arg_idx = 0;
+    results_reset();
+
+    return request_finish( como_main, status );
+}
+
+
+/**
+ * Undo journal steps back to the last token boundary before argument
+ * (see: como_parse()).
+ *
+ * @param ps Parse state.
+ * @param idx Index of first changed argument.
+ *
+ * @return Token step (or NULL if journal was emptied).
+ */
+static parse_step_t journal_undo( parse_state_t ps, pl_i64_t idx )
+{
+    parse_step_t step;
+    como_opt_t   o;
+
+    while ( ps->stepcnt > 0 ) {
+        step = &ps->steps[ --ps->stepcnt ];
+        o = step->opt;
+        switch ( step->kind ) {
+            case COMO_STEP_TOKEN:
+                if ( step->idx < idx ) {
+                    return step;
+                }
+                break;
+            case COMO_STEP_VALUE:
+                o->value_store.used -= sizeof( char* );
+                plcm_terminate_ptr( &o->value_store );
+                o->valuecnt = plcm_used_ptr( &o->value_store );
+                o->valuelen = NULL;
+                if ( o->ext ) {
+                    o->ext->map = NULL;
+                }
+                if ( o->valuecnt == 0 ) {
+                    o->value = NULL;
+                }
+                break;
+            case COMO_STEP_GIVEN:
+                o->given = pl_false;
+                bits_clear( COMO_BITS_GIVEN( step->cmd ), o - step->cmd->opts[ 0 ] );
+                break;
+            case COMO_STEP_COUNT:
+                step->cmd->givencnt--;
+                break;
+            case COMO_STEP_SUBCMD:
+                step->cmd->given = pl_false;
+                break;
+            case COMO_STEP_EXTERNAL:
+                step->cmd->external = NULL;
+                break;
+            case COMO_STEP_ERROR:
+                step->cmd->errors--;
+                break;
+            case COMO_STEP_OCCUR:
+                o->occurcnt--;
+                o->occur = NULL;
+                step->cmd->order = NULL;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Replace arguments of parse state from index onwards. If memory is
+ * not available, the arguments copied so far are kept.
+ *
+ * @param ps Parse state.
+ * @param idx Index of first changed argument.
+ * @param argc Argument count.
+ * @param argv Arguments.
+ *
+ * @return True if all arguments were copied.
+ */
+static pl_bool_t parse_args_update( parse_state_t ps, pl_i64_t idx, pl_i64_t argc, char** argv )
+{
+    char** args;
+
+    for ( pl_i64_t i = idx; i < ps->argcnt; i++ ) {
+        free( ps->args[ i ] );
+    }
+    ps->argcnt = idx;
+
+    if ( argc + 1 > ps->argcap ) {
+        args = realloc( ps->args, 2 * ( argc + 1 ) * sizeof( char* ) );
+        if ( !args ) {
+            if ( ps->args ) {
+                ps->args[ idx ] = NULL;
+            }
+            return pl_false;
+        }
+        ps->args = args;
+        ps->argcap = 2 * ( argc + 1 );
+    }
+
+    for ( pl_i64_t i = idx; i < argc; i++ ) {
+        ps->args[ i ] = strdup( argv[ i ] );
+        if ( !ps->args[ i ] ) {
+            return pl_false;
+        }
+        ps->argcnt = i + 1;
+    }
+    ps->args[ argc ] = NULL;
+
+    return pl_true;
+}
+
+
+/**
+ * Return deepest given command.
+ *
+ * @param cmd Main command.
+ *
+ * @return Given command.
+ */
+static como_cmd_t given_leaf( como_cmd_t cmd )
+{
+    while ( como_cmd_given_subcmd( cmd ) ) {
+        cmd = como_cmd_given_subcmd( cmd );
+    }
+
+    return cmd;
+}
+
+
+/**
+ * Return command with handler for given command, i.e. the command
+ * itself or its closest ancestor with handler. Missing handler is
+ * reported.
+ *
+ * @param cmd Given command.
+ *
+ * @return Command with handler (or NULL).
+ */
+static como_cmd_t request_handler( como_cmd_t cmd )
+{
+    como_cmd_t h;
+
+    for ( h = cmd; h && !h->handler; h = h->parent )
+        ;
+
+    if ( !h ) {
+        como_cmd = cmd;
+        como_error( "No handler for \"%s\"...", cmd->longname );
+    }
+
+    return h;
+}
+
+
+/**
+ * Run handler without exiting on quit.
+ *
+ * @param fn Handler.
+ * @param cmd Given command.
+ * @param arg Handler argument.
+ *
+ * @return Exit status.
+ */
+static int handler_run( como_handler_fn_t fn, como_cmd_t cmd, void* arg )
+{
+    if ( setjmp( serve_jmp ) ) {
+        serve_active = pl_false;
+        return serve_status;
+    }
+
+    serve_active = pl_true;
+    serve_status = fn( cmd, arg );
+    serve_active = pl_false;
+
+    return serve_status;
+}
+
+
+/**
+ * Parse request arguments and dispatch to handler of the given
+ * command (or its closest ancestor with handler).
+ *
+ * @param argc Argument count.
+ * @param argv Arguments.
+ *
+ * @return Exit status.
+ */
+static int serve_dispatch( pl_i64_t argc, char** argv )
+{
+    como_cmd_t cmd, h;
+    int        status;
+
+    if ( !request_parse( argc, argv, &status ) ) {
+        return status;
+    }
+
+    cmd = given_leaf( como_main );
+    h = request_handler( cmd );
+    if ( !h ) {
+        return EXIT_FAILURE;
+    }
+
+    return handler_run( h->handler, cmd, h->handler_arg );
+}
+
+
+/**
+ * Split command line to arguments in place. Arguments are separated
+ * by whitespace, and quoting follows the shell: single quotes,
+ * double quotes (with backslash escapes), and backslash escapes.
+ * Comment starts with "#".
+ *
+ * @param line Command line (modified).
+ * @param mem Memory for argument array.
+ * @param [out] argc Argument count.
+ *
+ * @return NULL terminated arguments.
+ */
+static char** split_line( char* line, plam_t mem, pl_i64_t* argc )
+{
+    char **argv, *r, *w, c;
+
+#define IS_SPACE( ch ) ( ( ch ) == ' ' || ( ch ) == '\t' || ( ch ) == '\n' || ( ch ) == '\r' )
+
+    /* Each argument takes at least two chars. */
+    argv = plam_get( mem, ( strlen( line ) / 2 + 2 ) * sizeof( char* ) );
+    *argc = 0;
+
+    r = line;
+    w = line;
+    for ( ;; ) {
+        while ( IS_SPACE( *r ) ) {
+            r++;
+        }
+        if ( !*r || *r == '#' ) {
+            break;
+        }
+
+        argv[ ( *argc )++ ] = w;
+        while ( *r && !IS_SPACE( *r ) ) {
+            if ( *r == '\'' ) {
+                r++;
+                while ( *r && *r != '\'' ) {
+                    *w++ = *r++;
+                }
+                if ( *r ) {
+                    r++;
+                }
+            } else if ( *r == '"' ) {
+                r++;
+                while ( *r && *r != '"' ) {
+                    if ( *r == '\\' && r[ 1 ] && strchr( "\"\\$`", r[ 1 ] ) ) {
+                        r++;
+                    }
+                    *w++ = *r++;
+                }
+                if ( *r ) {
+                    r++;
+                }
+            } else if ( *r == '\\' && r[ 1 ] ) {
+                r++;
+                *w++ = *r++;
+            } else {
+                *w++ = *r++;
+            }
+        }
+
+        /* Terminate (write position might be at the separator). */
+        c = *r;
+        *w++ = '\0';
+        if ( c ) {
+            r++;
+        }
+    }
+
+#undef IS_SPACE
+
+    argv[ *argc ] = NULL;
+    return argv;
+}
+
+
+/**
+ * Run batch job handler (with imported parse results) and close job
+ * output.
+ *
+ * @param job Job.
+ */
+static void batch_job_run( batch_job_t job )
+{
+    como_cmd_t cmd;
+
+    out_fh = job->fh;
+    err_fh = job->fh;
+
+    if ( job->fn ) {
+        cmd = import_results( job->buf, job->size, NULL );
+        if ( cmd ) {
+            local_main = cmd;
+            job->status = handler_run( job->fn, given_leaf( cmd ), job->arg );
+            local_main = NULL;
+            free( cmd );
+        } else {
+            job->status = EXIT_FAILURE;
+        }
+    }
+
+    out_fh = NULL;
+    err_fh = NULL;
+
+    fclose( job->fh );
+    free( job->buf );
+    job->buf = NULL;
+}
+
+
+/**
+ * Run batch jobs of own range, and steal half of other worker's range
+ * when own range is done.
+ *
+ * @param arg Worker.
+ *
+ * @return NULL.
+ */
+static void* batch_worker_run( void* arg )
+{
+    batch_worker_t w = arg;
+    batch_worker_t v;
+    batch_worker_t workers = w->workers;
+    pl_i64_t       i, n;
+    pl_bool_t      stolen;
+
+    for ( ;; ) {
+
+        pthread_mutex_lock( &w->lock );
+        i = ( w->beg < w->end ) ? w->beg++ : -1;
+        pthread_mutex_unlock( &w->lock );
+
+        if ( i >= 0 ) {
+            batch_job_run( w->jobs[ i ] );
+            continue;
+        }
+
+        /* Steal from the end of other range. */
+        stolen = pl_false;
+        for ( pl_i64_t k = 1; k < w->cnt && !stolen; k++ ) {
+            v = &workers[ ( w->id + k ) % w->cnt ];
+            pthread_mutex_lock( &v->lock );
+            n = v->end - v->beg;
+            if ( n > 0 ) {
+                n = ( n + 1 ) / 2;
+                v->end -= n;
+                i = v->end;
+                stolen = pl_true;
+            }
+            pthread_mutex_unlock( &v->lock );
+        }
+
+        if ( stolen ) {
+            /* Only one lock is held at a time. */
+            pthread_mutex_lock( &w->lock );
+            w->beg = i;
+            w->end = i + n;
+            pthread_mutex_unlock( &w->lock );
+        }
+
+        if ( !stolen ) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Check that client is run by the same user as the server (or root).
+ *
+ * @param conn Client connection.
+ *
+ * @return True if client is accepted.
+ */
+static pl_bool_t serve_peer_valid( int conn )
+{
+#ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t    len = sizeof( cred );
+
+    if ( getsockopt( conn, SOL_SOCKET, SO_PEERCRED, &cred, &len ) != 0 ||
+         len != sizeof( cred ) ) {
+        return pl_false;
+    }
+
+    return cred.uid == geteuid() || cred.uid == 0;
+#else
+    /* Socket is accessible only to the owner (see: como_serve()). */
+    (void)conn;
+    return pl_true;
+#endif
+}
+
+
+/**
+ * Check server request payload: it must include cwd, argc arguments,
+ * and envc environment strings, all null terminated.
+ *
+ * @param req Request header.
+ * @param payload Payload.
+ *
+ * @return True if valid.
+ */
+static pl_bool_t serve_payload_valid( serve_req_t req, const char* payload )
+{
+    pl_u64_t cnt = 0;
+
+    if ( payload[ req->size - 1 ] != '\0' ) {
+        return pl_false;
+    }
+
+    for ( pl_u32_t i = 0; i < req->size; i++ ) {
+        if ( payload[ i ] == '\0' ) {
+            cnt++;
+        }
+    }
+
+    return cnt >= 1 + (pl_u64_t)req->argc + req->envc;
+}
+
+
+/**
+ * Serve one client request. Client stdio, cwd, and environment are
+ * used for the duration of the request.
+ *
+ * @param conn Client connection.
+ */
+static void serve_request( int conn )
+{
+    extern char**   environ;
+    serve_req_s     req;
+    struct msghdr   msg;
+    struct iovec    iov;
+    struct cmsghdr* cm;
+    char            ctrl[ CMSG_SPACE( 3 * sizeof( int ) ) ];
+    char            serve_mem_buf[ COMO_SERVE_MEM_SIZE ];
+    plam_s          serve_mem;
+    int             fds[ 3 ], saved[ 3 ];
+    int             cwdfd, i, status;
+    char *          payload, *pos, **argv, **env, **env_saved;
+
+    memset( &msg, 0, sizeof( msg ) );
+    iov.iov_base = &req;
+    iov.iov_len = sizeof( req );
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof( ctrl );
+
+    if ( !serve_peer_valid( conn ) ) {
+        return;
+    }
+
+    if ( recvmsg( conn, &msg, MSG_WAITALL ) != sizeof( req ) ) {
+        return;
+    }
+
+    /* Exactly three fds are expected (others are closed). */
+    cm = CMSG_FIRSTHDR( &msg );
+    if ( !cm || cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS ) {
+        return;
+    }
+    if ( cm->cmsg_len != CMSG_LEN( 3 * sizeof( int ) ) || req.magic != COMO_SERVE_MAGIC ) {
+        for ( i = 0; i < (int)( ( cm->cmsg_len - CMSG_LEN( 0 ) ) / sizeof( int ) ); i++ ) {
+            close( ( (int*)CMSG_DATA( cm ) )[ i ] );
+        }
+        return;
+    }
+    memcpy( fds, CMSG_DATA( cm ), sizeof( fds ) );
+
+    /* Program name is required. */
+    payload = NULL;
+    if ( req.argc >= 1 && req.size > 0 && req.size <= COMO_SERVE_MAX_SIZE ) {
+        payload = malloc( req.size );
+    }
+    if ( !payload || !read_full( conn, payload, req.size ) ||
+         !serve_payload_valid( &req, payload ) ) {
+        free( payload );
+        for ( i = 0; i < 3; i++ ) {
+            close( fds[ i ] );
+        }
+        return;
+    }
+
+    /* Option values and request arrays are stored to request memory. */
+    plam_use( &serve_mem, serve_mem_buf, COMO_SERVE_MEM_SIZE );
+    value_mem = &serve_mem;
+
+    argv = plam_get( &serve_mem, ( req.argc + 1 ) * sizeof( char* ) );
+    env = plam_get( &serve_mem, ( req.envc + 1 ) * sizeof( char* ) );
+    pos = payload + strlen( payload ) + 1;
+    for ( pl_u32_t j = 0; j < req.argc; j++ ) {
+        argv[ j ] = pos;
+        pos += strlen( pos ) + 1;
+    }
+    argv[ req.argc ] = NULL;
+    for ( pl_u32_t j = 0; j < req.envc; j++ ) {
+        env[ j ] = pos;
+        pos += strlen( pos ) + 1;
+    }
+    env[ req.envc ] = NULL;
+
+    /* Switch to client context. */
+    fflush( stdout );
+    fflush( stderr );
+    for ( i = 0; i < 3; i++ ) {
+        saved[ i ] = dup( i );
+        dup2( fds[ i ], i );
+        close( fds[ i ] );
+    }
+    clearerr( stdin );
+    cwdfd = open( ".", O_RDONLY | O_DIRECTORY );
+    if ( chdir( payload ) != 0 ) {
+        /* Stay in server directory. */
+    }
+    env_saved = environ;
+    environ = env;
+
+    status = serve_dispatch( req.argc, argv );
+
+    /* Switch back to server context. */
+    environ = env_saved;
+    if ( cwdfd >= 0 ) {
+        if ( fchdir( cwdfd ) != 0 ) {
+            /* Nothing to do. */
+        }
+        close( cwdfd );
+    }
+    fflush( stdout );
+    fflush( stderr );
+    for ( i = 0; i < 3; i++ ) {
+        dup2( saved[ i ], i );
+        close( saved[ i ] );
+    }
+
+    results_reset();
+    value_mem = &como_mem;
+    plam_del( &serve_mem );
+    free( payload );
+
+    write_full( conn, &status, sizeof( status ) );
+}
+
+
+
+
+/**
+ * Create snapshot from parse results.
+ *
+ * @param cmd Main command of results.
+ *
+ * @return Snapshot (or NULL if out of memory).
+ */
+static como_snap_t snap_create( como_cmd_t cmd )
+{
+    como_snap_t snap;
+    pl_i64_t    size;
+
+    size = export_results( cmd, NULL, 0, NULL );
+    snap = malloc( sizeof( como_snap_s ) + size );
+    if ( !snap ) {
+        return NULL;
+    }
+    snap->buf = &snap[ 1 ];
+    export_results( cmd, snap->buf, size, NULL );
+    snap->cmd = import_results( snap->buf, size, NULL );
+    if ( !snap->cmd ) {
+        free( snap );
+        return NULL;
+    }
+    snap->refcnt = 1;
+
+    return snap;
+}
+
+
+/**
+ * Copy command hierarchy without parse results (see: watch_reload()).
+ * Specification, configuration, lookup keys, checks, and rules are
+ * shared. Options are copied for created options, and others are
+ * created from specification on use. Result fields are not bound.
+ *
+ * @param src Command to copy.
+ * @param parent Parent of copy (or NULL).
+ *
+ * @return Copy.
+ */
+static como_cmd_t cmd_clone( como_cmd_t src, como_cmd_t parent )
+{
+    como_cmd_t cmd;
+    como_opt_p opts;
+    como_opt_t store, o;
+    como_cmd_p sub;
+    pl_u64_t   subcnt, bitsize;
+
+    cmd = mem_get_for_type( como_cmd_s );
+    *cmd = *src;
+    cmd->parent = parent;
+    cmd->external = NULL;
+    cmd->given = pl_false;
+    cmd->givencnt = 0;
+    cmd->order = NULL;
+    cmd->ordercnt = 0;
+    cmd->errors = 0;
+
+    if ( src->opts ) {
+        opts = mem_get( ( src->optcnt + 1 ) * sizeof( como_opt_t ) );
+        store = mem_get( src->optcnt * sizeof( como_opt_s ) );
+        for ( pl_i64_t i = 0; i < src->optcnt; i++ ) {
+            o = &store[ i ];
+            *o = *src->opts[ i ];
+            memset( &o->value_store, 0, sizeof( plcm_s ) );
+            o->value = NULL;
+            o->valuelen = NULL;
+            o->valuecnt = 0;
+            o->given = pl_false;
+            o->occur = NULL;
+            o->occurcnt = 0;
+            if ( o->ext ) {
+                /* Validator is shared, but not bound fields. */
+                o->ext = mem_get_for_type( como_opt_ext_s );
+                o->ext->valid = src->opts[ i ]->ext->valid;
+                o->ext->map = NULL;
+                o->ext->bind = 0;
+                o->ext->target = NULL;
+            }
+            opts[ i ] = o;
+        }
+        opts[ src->optcnt ] = NULL;
+        cmd->opts = opts;
+
+        bitsize = 3 * src->bitwords * sizeof( pl_u64_t );
+        cmd->bits = mem_get( bitsize );
+        memcpy( cmd->bits, src->bits, bitsize );
+        memset( COMO_BITS_GIVEN( cmd ), 0, src->bitwords * sizeof( pl_u64_t ) );
+    }
+
+    memset( &cmd->subcmds, 0, sizeof( plcm_s ) );
+    subcnt = plcm_data( &src->subcmds ) ? plcm_used_ptr( &src->subcmds ) : 0;
+    if ( subcnt > 0 ) {
+        sub = mem_get( ( subcnt + 1 ) * sizeof( como_cmd_t ) );
+        for ( pl_u64_t i = 0; i < subcnt; i++ ) {
+            sub[ i ] = cmd_clone( ( (como_cmd_p)plcm_data( &src->subcmds ) )[ i ], cmd );
+        }
+        sub[ subcnt ] = NULL;
+        plcm_use( &cmd->subcmds, sub, ( subcnt + 1 ) * sizeof( como_cmd_t ) );
+        cmd->subcmds.used = subcnt * sizeof( como_cmd_t );
+    }
+
+    return cmd;
+}
+
+
+/**
+ * Close plugins loaded by copy of command hierarchy (see:
+ * cmd_clone()).
+ *
+ * @param cmd Copy.
+ * @param src Copied command.
+ */
+static void cmd_clone_end( como_cmd_t cmd, como_cmd_t src )
+{
+    como_cmd_p sub, srcsub;
+
+    if ( cmd->plugin_handle && !src->plugin_handle ) {
+        dlclose( cmd->plugin_handle );
+    }
+
+    sub = plcm_data( &cmd->subcmds );
+    srcsub = plcm_data( &src->subcmds );
+    for ( pl_u64_t i = 0; sub && i < plcm_used_ptr( &cmd->subcmds ); i++ ) {
+        cmd_clone_end( sub[ i ], srcsub[ i ] );
+    }
+}
+
+
+/**
+ * Collect arguments for reparse: program name, file arguments, and
+ * command line arguments.
+ *
+ * @param mem Memory for arguments.
+ * @param argc Argument count.
+ *
+ * @return Arguments (null terminated).
+ */
+static char** watch_args( plam_t mem, pl_i64_t* argc )
+{
+    FILE*    fh;
+    char*    text = NULL;
+    size_t   cap = 0;
+    char *   line, *next;
+    char **  args, **argv;
+    pl_i64_t cnt;
+    plcm_s   list;
+
+    plcm_empty( &list, 64 * sizeof( char* ) );
+    plcm_store_ptr( &list, watch_main->name );
+
+    fh = fopen( watch_file, "r" );
+    if ( fh ) {
+        if ( getdelim( &text, &cap, '\0', fh ) > 0 ) {
+            line = plam_store_string( mem, text );
+            for ( ; line; line = next ) {
+                next = strchr( line, '\n' );
+                if ( next ) {
+                    *next++ = '\0';
+                }
+                args = split_line( line, mem, &cnt );
+                for ( pl_i64_t i = 0; i < cnt; i++ ) {
+                    plcm_store_ptr( &list, args[ i ] );
+                }
+            }
+        }
+        free( text );
+        fclose( fh );
+    }
+
+    for ( pl_i64_t i = 0; i < watch_argc; i++ ) {
+        plcm_store_ptr( &list, watch_argv[ i ] );
+    }
+
+    *argc = plcm_used_ptr( &list );
+    argv = plam_get( mem, ( *argc + 1 ) * sizeof( char* ) );
+    memcpy( argv, plcm_data( &list ), *argc * sizeof( char* ) );
+    argv[ *argc ] = NULL;
+    plcm_del( &list );
+
+    return argv;
+}
+
+
+/**
+ * Parse command line with file arguments to a new snapshot. Results
+ * are parsed to a private copy of the command hierarchy (in watcher
+ * thread), hence program's own results are not changed. Errors (and
+ * usage) are displayed to stderr.
+ *
+ * @return Snapshot (or NULL for errors).
+ */
+static como_snap_t watch_reload( void )
+{
+    char        mem_buf[ COMO_SERVE_MEM_SIZE ];
+    plam_s      mem;
+    char**      argv;
+    pl_i64_t    argc;
+    int         status;
+    como_cmd_t  cmd;
+    como_snap_t snap = NULL;
+
+    plam_use( &mem, mem_buf, COMO_SERVE_MEM_SIZE );
+    local_mem = &mem;
+    value_mem = &mem;
+    out_fh = stderr;
+
+    argv = watch_args( &mem, &argc );
+    cmd = cmd_clone( watch_main, NULL );
+
+    local_main = cmd;
+    arg_cnt = argc - 1;
+    arg_vec = argv + 1;
+    arg_idx = 0;
+    if ( request_finish( cmd, &status ) ) {
+        snap = snap_create( cmd );
+    }
+    local_main = NULL;
+    args_release();
+
+    out_fh = NULL;
+    cmd_clone_end( cmd, watch_main );
+    value_mem = &como_mem;
+    local_mem = NULL;
+    plam_del( &mem );
+
+    return snap;
+}
+
+
+/**
+ * Check if option differs between snapshots.
+ *
+ * @param old Option in previous snapshot (or NULL).
+ * @param opt Option in new snapshot (or NULL).
+ *
+ * @return True if changed.
+ */
+static pl_bool_t opt_changed( como_opt_t old, como_opt_t opt )
+{
+    char **a, **b;
+
+    if ( !old || !opt ) {
+        return ( old && old->given ) || ( opt && opt->given );
+    }
+
+    if ( old->given != opt->given || old->valuecnt != opt->valuecnt ) {
+        return pl_true;
+    }
+
+    for ( a = opt_values( old ), b = opt_values( opt ); *a && *b; a++, b++ ) {
+        if ( strcmp( *a, *b ) != 0 ) {
+            return pl_true;
+        }
+    }
+
+    return pl_false;
+}
+
+
+/**
+ * Report changed options of command and its subcmds. Snapshots have
+ * the same command hierarchy, but options might exist only in the new
+ * one (created on first use).
+ *
+ * @param old Command in previous snapshot.
+ * @param cmd Command in new snapshot.
+ */
+static void watch_changes( como_cmd_t old, como_cmd_t cmd )
+{
+    como_opt_t o, n;
+    como_cmd_p os, ns;
+    pl_i64_t   cnt;
+
+    cnt = old->optcnt > cmd->optcnt ? old->optcnt : cmd->optcnt;
+    for ( pl_i64_t i = 0; i < cnt; i++ ) {
+        o = i < old->optcnt ? old->opts[ i ] : NULL;
+        n = i < cmd->optcnt ? cmd->opts[ i ] : NULL;
+        if ( opt_changed( o, n ) ) {
+            watch_fn( cmd, o, n, watch_arg );
+        }
+    }
+
+    os = plcm_data( &old->subcmds );
+    ns = plcm_data( &cmd->subcmds );
+    cnt = plcm_used_ptr( &cmd->subcmds );
+    for ( pl_i64_t i = 0; i < cnt && i < (pl_i64_t)plcm_used_ptr( &old->subcmds ); i++ ) {
+        watch_changes( os[ i ], ns[ i ] );
+    }
+}
+
+
+/**
+ * Publish snapshot (or NULL) and release the previous one after grace
+ * period. Epoch is flipped after pointer swap, and readers that
+ * entered in the previous epoch (and might have seen the previous
+ * snapshot) are waited to take their reference.
+ *
+ * @param snap Snapshot.
+ */
+static void snap_publish( como_snap_t snap )
+{
+    como_snap_t old;
+    pl_u64_t    epoch;
+
+    old = __atomic_exchange_n( &snap_current, snap, __ATOMIC_SEQ_CST );
+    epoch = __atomic_fetch_add( &snap_epoch, 1, __ATOMIC_SEQ_CST );
+
+    while ( __atomic_load_n( &snap_readers[ epoch & 1 ], __ATOMIC_SEQ_CST ) > 0 ) {
+        sched_yield();
+    }
+
+    if ( old ) {
+        if ( snap && watch_fn ) {
+            watch_changes( old->cmd, snap->cmd );
+        }
+        como_snap_put( old );
+    }
+}
+
+
+/**
+ * Watcher thread. Directory of file is watched, since editors
+ * typically replace the file.
+ *
+ * @param arg Not used.
+ *
+ * @return NULL.
+ */
+static void* watch_run( void* arg )
+{
+    char                  buf[ 4096 ] __attribute__( ( aligned( 8 ) ) );
+    struct pollfd         pfd;
+    struct inotify_event* ev;
+    const char*           base;
+    como_snap_t           snap;
+    pl_bool_t             changed;
+    ssize_t               len;
+
+    (void)arg;
+
+    /* Initial file arguments (see: como_watch()). */
+    snap = watch_reload();
+    if ( snap ) {
+        snap_publish( snap );
+    }
+    sem_post( &watch_ready );
+
+    base = strrchr( watch_file, '/' );
+    base = base ? base + 1 : watch_file;
+
+    pfd.fd = watch_fd;
+    pfd.events = POLLIN;
+
+    while ( !__atomic_load_n( &watch_stop, __ATOMIC_ACQUIRE ) ) {
+
+        if ( poll( &pfd, 1, COMO_WATCH_POLL_MS ) <= 0 ) {
+            continue;
+        }
+
+        len = read( watch_fd, buf, sizeof( buf ) );
+        changed = pl_false;
+        for ( char* p = buf; len > 0 && p < buf + len; p += sizeof( *ev ) + ev->len ) {
+            ev = (struct inotify_event*)p;
+            if ( ev->len > 0 && strcmp( ev->name, base ) == 0 ) {
+                changed = pl_true;
+            }
+        }
+
+        if ( changed ) {
+            snap = watch_reload();
+            if ( snap ) {
+                snap_publish( snap );
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * ------------------------------------------------------------
+ * Como public functions.
+ */
+
+
+void como_finish( void )
+{
+    finish_from( como_main );
+}
+
+
+como_opt_t como_opt( char* name )
+{
+    return find_opt_by_name( query_cmd(), name );
+}
+
+
+char** como_value( char* name )
+{
+    como_opt_t co;
+    co = find_opt_by_name( query_cmd(), name );
+    return opt_values( co );
+}
+
+
+como_opt_t como_given( char* name )
+{
+    como_opt_t co;
+    co = find_opt_by_name( query_cmd(), name );
+    if ( co->given ) {
+        return co;
+    } else {
+        return NULL;
+    }
+}
+
+
+como_opt_t como_cmd_opt( como_cmd_t cmd, char* name )
+{
+    cmd_materialize( cmd );
+    return find_opt_by_name( cmd, name );
+}
+
+
+char** como_cmd_value( como_cmd_t cmd, char* name )
+{
+    como_opt_t co;
+    cmd_materialize( cmd );
+    co = find_opt_by_name( cmd, name );
+    return opt_values( co );
+}
+
+
+como_opt_t como_cmd_given( como_cmd_t cmd, char* name )
+{
+    como_opt_t co;
+    cmd_materialize( cmd );
+    co = find_opt_by_name( cmd, name );
+    if ( co->given ) {
+        return co;
+    } else {
+        return NULL;
+    }
+}
+
+
+como_opt_t como_opt_at( como_handle_t handle )
+{
+    return como_cmd_opt_at( query_cmd(), handle );
+}
+
+
+char** como_value_at( como_handle_t handle )
+{
+    return como_cmd_value_at( query_cmd(), handle );
+}
+
+
+como_opt_t como_given_at( como_handle_t handle )
+{
+    return como_cmd_given_at( query_cmd(), handle );
+}
+
+
+como_opt_t como_cmd_opt_at( como_cmd_t cmd, como_handle_t handle )
+{
+    cmd_materialize( cmd );
+    return opt_at( cmd, handle );
+}
+
+
+char** como_cmd_value_at( como_cmd_t cmd, como_handle_t handle )
+{
+    como_opt_t co;
+    cmd_materialize( cmd );
+    co = opt_at( cmd, handle );
+    return co ? opt_values( co ) : NULL;
+}
+
+
+como_opt_t como_cmd_given_at( como_cmd_t cmd, como_handle_t handle )
+{
+    como_opt_t co;
+    cmd_materialize( cmd );
+    co = opt_at( cmd, handle );
+    return ( co && co->given ) ? co : NULL;
+}
+
+
+pl_i64_t como_resolve( como_cmd_t cmd, const char** names, como_handle_t* handles, pl_i64_t cnt )
+{
+    como_opt_t co;
+    pl_i64_t   resolved = 0;
+
+    cmd_materialize( cmd );
+
+    for ( pl_i64_t i = 0; i < cnt; i++ ) {
+        co = find_opt_by_name( cmd, (char*)names[ i ] );
+        if ( co ) {
+            handles[ i ] = ( co - cmd->opts[ 0 ] ) - ( cmd->optcnt - cmd->specsize );
+            resolved++;
+        } else {
+            handles[ i ] = COMO_NO_HANDLE;
+        }
+    }
+
+    return resolved;
+}
+
+
+como_cmd_t como_cmd_subcmd( como_cmd_t cmd, char* name )
+{
+    como_cmd_p subcmd;
+
+    if ( plcm_is_empty( &cmd->subcmds ) ) {
+        return NULL;
+    }
+
+    subcmd = plcm_data( &cmd->subcmds );
+    while ( (pl_t)subcmd < plcm_end( &cmd->subcmds ) ) {
+        if ( strcmp( ( *subcmd )->name, name ) == 0 ) {
+            return *subcmd;
+        }
+        subcmd++;
+    }
+
+    return NULL;
+}
+
+
+como_cmd_t como_given_subcmd( void )
+{
+    return como_cmd_given_subcmd( query_cmd() );
+}
+
+
+const char* como_map_get( como_opt_t opt, const char* key )
+{
+    /* Table exists for given map options (also when imported). */
+    if ( !opt->ext || !opt->ext->map ) {
+        return NULL;
+    }
+
+    return map_slot( opt->ext->map, key, strlen( key ) )->value;
+}
+
+
+como_map_t como_map( como_opt_t opt )
+{
+    return opt->ext ? opt->ext->map : NULL;
+}
+
+pl_i64_t como_count( char* name )
+{
+    como_opt_t co;
+    co = find_opt_by_name( query_cmd(), name );
+    return co->occurcnt;
+}
+
+
+pl_i64_t como_cmd_count( como_cmd_t cmd, char* name )
+{
+    como_opt_t co;
+    cmd_materialize( cmd );
+    co = find_opt_by_name( cmd, name );
+    return co->occurcnt;
+}
+
+
+void como_iter_init( como_iter_t it, como_cmd_t cmd )
+{
+    it->cmd = cmd;
+    it->pos = 0;
+    it->opt = NULL;
+    it->occur = NULL;
+}
+
+
+pl_bool_t como_iter_next( como_iter_t it )
+{
+    if ( it->pos >= it->cmd->ordercnt ) {
+        return pl_false;
+    }
+
+    it->occur = it->cmd->order[ it->pos++ ];
+    it->opt = it->cmd->opts[ it->occur->opt ];
+
+    return pl_true;
+}
+
+
+como_cmd_t como_cmd_given_subcmd( como_cmd_t parent )
+{
+    como_cmd_p cmd;
+
+    if ( plcm_is_empty( &parent->subcmds ) ) {
+        return NULL;
+    }
+
+    cmd = plcm_data( &parent->subcmds );
+    while ( (pl_t)cmd < plcm_end( &parent->subcmds ) ) {
+        if ( ( *cmd )->given ) {
+            return *cmd;
+        }
+        cmd++;
+    }
+
+    return NULL;
+}
+
+
+char** como_external( void )
+{
+    return local_main ? local_main->external : como_main->external;
+}
+
+
+const char* como_opt_id( como_opt_t opt )
+{
+    if ( opt->type != COMO_SUBCMD ) {
+        return opt->shortopt ? opt->shortopt : opt->longopt;
+    } else {
+        return opt->name;
+    }
+}
+
+
+/*
+ * Functions to set configuration items.
+ */
+
+void como_conf_autohelp( pl_bool_t val )
+{
+    config_own( como_cmd )->autohelp = val;
+}
+
+void como_conf_header( char* val )
+{
+    config_own( como_cmd )->header = mem_store_string( val );
+}
+
+void como_conf_footer( char* val )
+{
+    config_own( como_cmd )->footer = mem_store_string( val );
+}
+
+void como_conf_subcheck( pl_bool_t val )
+{
+    config_own( como_cmd )->subcheck = val;
+}
+
+void como_conf_check_missing( pl_bool_t val )
+{
+    config_own( como_cmd )->check_missing = val;
+}
+
+void como_conf_check_invalid( pl_bool_t val )
+{
+    config_own( como_cmd )->check_invalid = val;
+}
+
+void como_conf_tab( pl_i64_t val )
+{
+    config_own( como_cmd )->tab = val;
+}
+
+void como_conf_help_exit( pl_bool_t val )
+{
+    config_own( como_cmd )->help_exit = val;
+}
+
+void como_conf_threads( pl_i64_t val )
+{
+    config_own( como_cmd )->threads = val;
+}
+
+void como_conf_map_dup( pl_i64_t val )
+{
+    config_own( como_cmd )->map_dup = val;
+}
+
+void como_conf_validator( char* name, como_valid_fn_t fn, void* arg )
+{
+    como_opt_t o;
+
+    cmd_materialize( como_cmd );
+    o = find_opt_by_name( como_cmd, name );
+    if ( !o ) {
+        como_fatal( "Option \"%s\" does not exist!", name );
+        return;
+    }
+
+    opt_ext( o )->valid = mem_get_for_type( como_valid_s );
+    o->ext->valid->fn = fn;
+    o->ext->valid->arg = arg;
+}
+
+
+void como_rule( pl_i64_t kind, const char** names )
+{
+    como_rule_t  r;
+    como_opt_t   o;
+    como_rule_t* tail;
+
+    cmd_materialize( como_cmd );
+
+    r = mem_get_for_type( como_rule_s );
+    r->kind = kind;
+    r->first = -1;
+    r->next = NULL;
+    r->mask = mem_get( como_cmd->bitwords * sizeof( pl_u64_t ) );
+    memset( r->mask, 0, como_cmd->bitwords * sizeof( pl_u64_t ) );
+
+    for ( ; *names; names++ ) {
+        o = find_opt_by_name( como_cmd, (char*)*names );
+        if ( !o ) {
+            como_fatal( "Option \"%s\" does not exist!", *names );
+            return;
+        }
+        if ( r->first < 0 &&
+             ( kind == COMO_RULE_KIND_REQUIRES || kind == COMO_RULE_KIND_CONFLICTS ) ) {
+            r->first = o - como_cmd->opts[ 0 ];
+        } else {
+            bits_set( r->mask, o - como_cmd->opts[ 0 ] );
+        }
+    }
+
+    /* Keep rules in specification order. */
+    tail = &como_cmd->rules;
+    while ( *tail ) {
+        tail = &( *tail )->next;
+    }
+    *tail = r;
+}
+
+
+void como_bind( const char* name, pl_i64_t kind, void* target )
+{
+    como_opt_t o;
+
+    cmd_materialize( como_cmd );
+    o = find_opt_by_name( como_cmd, (char*)name );
+    if ( !o ) {
+        como_fatal( "Option \"%s\" does not exist!", name );
+        return;
+    }
+
+    opt_ext( o )->bind = kind;
+    o->ext->target = target;
+}
+
+
+/*
+ * Predefined validators.
+ */
+
+pl_bool_t como_valid_integer( const char* value, void* arg )
+{
+    char* end;
+
+    errno = 0;
+    strtoll( value, &end, 0 );
+    if ( value[ 0 ] == 0 || *end != 0 || errno != 0 ) {
+        return pl_false;
+    } else {
+        return pl_true;
+    }
+}
+
+pl_bool_t como_valid_path( const char* value, void* arg )
+{
+    return ( access( value, arg ? *(int*)arg : F_OK ) == 0 );
+}
+
+pl_bool_t como_valid_regex( const char* value, void* arg )
+{
+    return ( regexec( (regex_t*)arg, value, 0, NULL, 0 ) == 0 );
+}
+
+
+void como_error( const char* format, ... )
+{
+    como_cmd_t cmd = query_cmd();
+
+    /* Batch handler and reload count errors to private results. */
+    cmd->errors++;
+    if ( !local_main ) {
+        journal_add( COMO_STEP_ERROR, cmd, NULL );
+    }
+
+    va_list ap;
+    FILE*   fh = como_err();
+
+    COMO_PROBE2( error, cmd->name, format );
+
+    fputc( '\n', fh );
+    fputs( cmd->name, fh );
+    fputs( " error: ", fh );
+    va_start( ap, format );
+    vfprintf( fh, format, ap );
+    va_end( ap );
+    fputc( '\n', fh );
+}
+
+
+void como_usage( void )
+{
+    como_cmd_usage( query_cmd() );
+}
+
+
+void como_cmd_usage( como_cmd_t cmd )
+{
+    plcm_t str;
+
+    como_opt_p co;
+    pl_bool_t  main_cmd, has_visible;
+    pl_u64_t   mark, size;
+
+    COMO_PROBE1( usage, cmd->longname );
+
+    cmd_materialize( cmd );
+
+    plcm_declare( str_handle, 8192 );
+    str = &str_handle;
+
+    /* Usage text is released after display. */
+    mark = fixed_used;
+    if ( fixed_mem ) {
+        size = usage_size( cmd );
+        plcm_use( str, mem_get( size ), size );
+    }
+
+    if ( cmd->conf->header ) {
+        plss_format_string( str, "%s", cmd->conf->header );
+    } else {
+        plss_append_char( str, '\n' );
+    }
+
+    if ( !cmd->parent ) {
+        /* Main command. */
+        main_cmd = pl_true;
+    } else {
+        /* Subcmd. */
+        main_cmd = pl_false;
+    }
+
+
+    if ( main_cmd ) {
+        plss_format_string( str, "  %s", cmd->name );
+    } else {
+        plss_format_string( str, "  Subcommand \"%s\" usage:\n    ", cmd->name );
+        plss_format_string( str, "%s", cmd->longname );
+    }
+
+    /* Command line. */
+    has_visible = pl_false;
+    co = cmd->opts;
+    while ( *co ) {
+        if ( !( ( *co )->type & COMO_P_HIDDEN ) ) {
+
+            has_visible = pl_true;
+
+            plss_append_char( str, ' ' );
+            if ( ( *co )->type != COMO_SUBCMD ) {
+                opt_cmdline( str, *co );
+            } else {
+                plss_append_string( str, "<<subcommand>>" );
+                break;
+            }
+        }
+        co++;
+    }
+
+    plss_append_string( str, "\n\n" );
+
+    /* If cmd has subcmds, use categories: Options, Subcommands. */
+
+    if ( !plcm_is_empty( &cmd->subcmds ) && has_visible ) {
+        plss_append_string( str, "  Options:\n" );
+    }
+
+    /* Option documents. */
+    co = cmd->opts;
+    while ( *co ) {
+        if ( ( *co )->type != COMO_SUBCMD ) {
+            opt_doc( str, *co, cmd );
+        }
+        co++;
+    }
+
+    if ( !plcm_is_empty( &cmd->subcmds ) ) {
+        plss_append_string( str, "\n  Subcommands:\n" );
+    }
+
+    /* Subcmd documents. */
+    co = cmd->opts;
+    while ( *co ) {
+        if ( ( *co )->type == COMO_SUBCMD ) {
+            opt_doc( str, *co, cmd );
+        }
+        co++;
+    }
+
+    if ( main_cmd ) {
+        plss_format_string( str, "\n\n  Copyright (c) %s by %s\n", cmd->year, cmd->author );
+    } else {
+        plss_append_string( str, "\n" );
+    }
+
+    if ( cmd->conf->footer ) {
+        plss_format_string( str, "%s", cmd->conf->footer );
+    } else {
+        plss_append_char( str, '\n' );
+    }
+
+    fputs( plss_string( str ), como_out() );
+
+    plcm_del( str );
+    if ( fixed_mem ) {
+        fixed_used = mark;
+    }
+
+    if ( cmd->conf->help_exit ) {
+        quit( EXIT_FAILURE );
+    }
+}
+
+
+void como_display_values( FILE* fh, como_opt_t o )
+{
+    char**    value;
+    pl_bool_t first = pl_true;
+
+    if ( ( o->type & COMO_P_MANY ) || ( o->type & COMO_P_DEFAULT ) ) {
+        fprintf( fh, "[" );
+        value = opt_values( o );
+        while ( *value ) {
+            if ( !first ) {
+                fprintf( fh, ", " );
+            }
+            fprintf( fh, "\"%s\"", *value );
+            first = pl_false;
+            value++;
+        }
+        fprintf( fh, "]" );
+    } else {
+        value = opt_values( o );
+        fprintf( fh, "%s", *value );
+    }
+}
+
+
+pl_i64_t como_export( void* buf, pl_i64_t size )
+{
+    return export_results( como_main, buf, size, NULL );
+}
+
+
+como_cmd_t como_import( const void* buf, pl_i64_t size )
+{
+    como_cmd_t cmd;
+
+    cmd = import_results( buf, size, NULL );
+    if ( cmd ) {
+        como_main = cmd;
+        como_cmd = cmd;
     }
+
+    return cmd;
 }
 
 
-/**
- * Proxy for parse_opts. Checks for status after each subcmd and
- * recurses further if no errors.
- *
- * @param cmd Command to parse.
- * @param errcmd Command having errors.
- *
- * @return True if no errors.
- */
-static pl_bool_t setup_and_parse( como_cmd_t cmd, como_cmd_p errcmd )
+void como_import_end( como_cmd_t cmd )
 {
-    pl_i64_t   ret;
-    como_cmd_t subcmd;
-    como_opt_t o;
+    free( cmd );
+}
 
-    ret = parse_opts( cmd, &subcmd );
 
-    for ( pl_u64_t i = 0; i < cmd->optcnt; i++ ) {
-        /* Update the "value" pointers of options to refer the
-           collected option values. */
-        o = cmd->opts[ i ];
-        if ( o->type != COMO_SUBCMD ) {
-            if ( plcm_used_ptr( &o->value_store ) > 0 ) {
-                o->value = plcm_data( &o->value_store );
-            } else if ( ( o->type & COMO_P_MANY ) || ( o->type & COMO_P_DEFAULT ) ) {
-                o->value = plcm_data( &o->value_store );
-            }
-        }
-        o->valuecnt = plcm_used_ptr( &o->value_store );
+como_cmd_t como_freeze( void )
+{
+    void*      buf;
+    char*      block;
+    pl_i64_t   size;
+    pl_u64_t   offset, total, page, writable, cmdcnt;
+    como_cmd_t cmd;
+    como_cmd_p c;
+
+    if ( fixed_mem || frozen_mem ) {
+        return como_main;
     }
 
-    if ( ret == 0 ) {
-        /* done.*/
-        return pl_true;
-    } else if ( ret == 1 ) {
-        /* continue. */
-        return setup_and_parse( subcmd, errcmd );
-    } else if ( ret == 2 ) {
-        /* error. */
-        *errcmd = subcmd;
-        return pl_false;
-    } else {
-        return pl_true;
+    size = como_export( NULL, 0 );
+    buf = malloc( size );
+    if ( !buf ) {
+        return NULL;
+    }
+    como_export( buf, size );
+
+    /* Views and export (strings) in one page aligned block. Commands
+       and configs are first, and their pages remain writable (error
+       count and configuration). */
+    page = sysconf( _SC_PAGESIZE );
+    cmdcnt = ( (export_hdr_t)buf )->cmdcnt;
+    offset = ( import_size( buf, size ) + 7 ) & ~7ULL;
+    total = ( offset + size + page - 1 ) & ~( page - 1 );
+    block = mmap( NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( block == MAP_FAILED ) {
+        free( buf );
+        return NULL;
     }
+    memcpy( block + offset, buf, size );
+    free( buf );
+
+    cmd = import_results( block + offset, size, block );
+    writable = ( cmdcnt * ( sizeof( como_cmd_s ) + sizeof( como_config_s ) ) + page - 1 ) &
+               ~( page - 1 );
+    if ( writable < total ) {
+        mprotect( block + writable, total - writable, PROT_READ );
+    }
+
+    /* Release commands, value stores, and arena. Pages of the initial
+       arena are returned to the system, and arena is empty for
+       como_end() (and configuration changes). */
+    for ( c = plcm_data( &cmd_list ); (pl_t)c < plcm_end( &cmd_list ); c++ ) {
+        como_cmd_end( *c );
+    }
+    plcm_del( &cmd_list );
+    plam_del( &como_mem );
+    args_release();
+    madvise( (void*)( ( (uintptr_t)como_init_mem + page - 1 ) & ~( page - 1 ) ),
+             ( COMO_INIT_MEM_SIZE - page ) & ~( page - 1 ),
+             MADV_DONTNEED );
+    plam_use( &como_mem, como_init_mem, COMO_INIT_MEM_SIZE );
+    plcm_use_plam( &cmd_list, &como_mem, 16 * sizeof( como_cmd_t ) );
+
+    frozen_mem = block;
+    frozen_size = total;
+    como_main = cmd;
+    como_cmd = cmd;
+
+    return cmd;
 }
 
 
-/**
- * Add option's command line formatting (usage) to str.
- *
- * @param [out] str String where command line is stored.
- * @param [in] o Option to add.
- */
-static void opt_cmdline( plcm_t str, como_opt_t o )
+int como_spec_save( const char* file, const char* key )
 {
-    if ( o->type & COMO_P_HIDDEN ) {
-        return;
+    como_cmd_p c;
+    void*      buf;
+    char*      tmp;
+    FILE*      fh;
+    pl_i64_t   size;
+    int        ret = 0;
+
+    /* Export includes only created options. */
+    for ( c = plcm_data( &cmd_list ); (pl_t)c < plcm_end( &cmd_list ); c++ ) {
+        cmd_materialize( *c );
     }
 
-    if ( o->type & COMO_P_OPT ) {
-        if ( o->type & COMO_P_MUTEX ) {
-            plss_append( str, plsr_from_string( "{" ) );
-        } else {
-            plss_append( str, plsr_from_string( "[" ) );
-        }
+    size = export_results( como_main, NULL, 0, key );
+    buf = malloc( size );
+    tmp = malloc( strlen( file ) + 32 );
+    if ( !buf || !tmp ) {
+        free( buf );
+        free( tmp );
+        return -1;
     }
+    export_results( como_main, buf, size, key );
 
-    plss_format_string( str, "%s", como_opt_id( o ) );
-
-    if ( !has_switch_style_doc( o ) ) {
-        plss_format_string( str, " <%s>", o->name );
-
-        if ( ( o->type & COMO_P_NONE ) && ( o->type & COMO_P_MANY ) ) {
-            plss_append( str, plsr_from_string( "*" ) );
-        } else if ( o->type & COMO_P_MANY ) {
-            plss_append( str, plsr_from_string( "+" ) );
+    sprintf( tmp, "%s.%ld", file, (long)getpid() );
+    fh = fopen( tmp, "wb" );
+    if ( !fh ) {
+        ret = -1;
+    } else {
+        if ( fwrite( buf, 1, size, fh ) != (size_t)size ) {
+            ret = -1;
         }
-    }
-
-    if ( o->type & COMO_P_OPT ) {
-        if ( o->type & COMO_P_MUTEX ) {
-            plss_append( str, plsr_from_string( "}" ) );
-        } else {
-            plss_append( str, plsr_from_string( "]" ) );
+        if ( fclose( fh ) != 0 ) {
+            ret = -1;
+        }
+        if ( ret == 0 && rename( tmp, file ) != 0 ) {
+            ret = -1;
+        }
+        if ( ret != 0 ) {
+            unlink( tmp );
         }
     }
+
+    free( tmp );
+    free( buf );
+
+    return ret;
 }
 
 
-/**
- * Add option documentation line.
- *
- * @param str String where document is stored.
- * @param o Option to document.
- * @param cmd Containing command (for configuration lookup).
- */
-static void opt_doc( plcm_t str, como_opt_t o, como_cmd_t cmd )
+int como_spec_load( const char* file, const char* key )
 {
-    const char* format;
-    pl_i64_t    s, e;
-    pl_bool_t   first;
-
-    if ( o->type & COMO_P_HIDDEN ) {
-        return;
+    const export_hdr_s* hdr;
+    export_cmd_t        ecmds, ec;
+    export_opt_t        eopts;
+    como_cmd_p          cmds;
+    como_cmd_t          cmd, parent;
+    struct stat         st;
+    char*               base;
+    pl_u64_t            i;
+    int                 fd;
+
+    if ( spec_image ) {
+        return -1;
     }
 
-    plcm_declare( format_str, 128 );
-    plss_format_string( &format_str, "  %%-%ds", cmd->conf->tab );
-    format = plss_string( &format_str );
-
-    /* Reformat doc str, so that newlines start a new line and tab
-     * chars align the start to previous line. */
+    fd = open( file, O_RDONLY );
+    if ( fd < 0 ) {
+        return -1;
+    }
+    if ( fstat( fd, &st ) != 0 || (pl_u64_t)st.st_size < sizeof( export_hdr_s ) ) {
+        close( fd );
+        return -1;
+    }
+    base = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if ( base == MAP_FAILED ) {
+        return -1;
+    }
 
-    first = pl_true;
-    s = 0;
-    e = 0;
-    for ( ;; ) {
-        if ( o->doc[ e ] == '\n' || o->doc[ e ] == 0 ) {
-            if ( first ) {
-                plss_format_string( str, format, como_opt_id( o ) );
-                plss_append( str,
-                             plsr_from_string_and_length( (char*)&( o->doc[ s ] ), ( e - s ) ) );
-                plss_append_char( str, '\n' );
+    hdr = (const export_hdr_s*)base;
+    /* Stale cache (of other spec) is not used. */
+    if ( import_size( base, st.st_size ) == 0 ||
+         !str_same( hdr->key ? base + hdr->key : NULL, key ) ) {
+        munmap( base, st.st_size );
+        return -1;
+    }
 
-                if ( o->doc[ e ] == 0 ) {
-                    return;
-                } else {
-                    e++;
-                }
+    spec_image = base;
+    spec_image_size = st.st_size;
 
-                first = pl_false;
-            } else {
-                if ( o->doc[ s ] == '\t' ) {
-                    s++;
-                    plss_format_string( str, format, "" );
-                }
-                plss_append( str,
-                             plsr_from_string_and_length( (char*)&( o->doc[ s ] ), ( e - s ) ) );
-                plss_append_char( str, '\n' );
+#define IMAGE_STR( off ) ( ( off ) ? base + ( off ) : NULL )
 
-                if ( o->doc[ e ] == 0 ) {
-                    return;
-                } else {
-                    e++;
-                }
-            }
-            s = e;
+    ecmds = (export_cmd_t)( base + sizeof( export_hdr_s ) );
+    eopts = (export_opt_t)( ecmds + hdr->cmdcnt );
+    cmds = mem_get( hdr->cmdcnt * sizeof( como_cmd_t ) );
 
+    /* Commands are in depth first order, i.e. parent is before its
+       subcmds, and subcmds are in specification order. */
+    for ( i = 0; i < hdr->cmdcnt; i++ ) {
+        ec = &ecmds[ i ];
+        if ( ec->parent < 0 ) {
+            cmd = como_cmd;
+            como_main = como_cmd;
+            cmd->conf = como_conf;
         } else {
-            e++;
+            parent = cmds[ ec->parent ];
+            cmd = cmd_create();
+            cmd->parent = parent;
+            add_subcmd( parent, cmd );
+            cmd->conf = config_share( parent->conf );
         }
-    }
-}
+        cmd->name = IMAGE_STR( ec->name );
+        cmd->longname = IMAGE_STR( ec->longname );
 
+        image_conf( cmd, ec );
 
-/**
- * Display help if help option is given for any of the commands in the
- * hierarchy (recursion).
- *
- * @param cmd Command to search given help.
- */
-static void usage_if_help( como_cmd_t cmd )
-{
-    como_cmd_t subcmd;
+        /* Options are created when command is used. Exported help
+           option is skipped, since it is added by materialization. */
+        cmd->spec = NULL;
+        cmd->specsize = ec->specsize;
+        cmd->image = &eopts[ ec->opt + ec->optcnt - ec->specsize ];
+        cmd->optcnt = 0;
 
-    if ( como_cmd_given( cmd, "help" ) ) {
-        como_cmd_usage( cmd );
-    } else if ( !plcm_is_empty( &cmd->subcmds ) && ( subcmd = como_cmd_given_subcmd( cmd ) ) ) {
-        usage_if_help( subcmd );
+        cmds[ i ] = cmd;
     }
-}
 
+#undef IMAGE_STR
 
-static void quit( int status )
-{
-    como_end();
-    exit( status );
-}
+    como_cmd = como_main;
 
+    return 0;
+}
 
 
-/*
- * ------------------------------------------------------------
- * Como public functions.
- */
+void como_handler( como_handler_fn_t fn, void* arg )
+{
+    como_cmd->handler = fn;
+    como_cmd->handler_arg = arg;
+}
 
 
-void como_finish( void )
+int como_serve( const char* path )
 {
-    como_cmd_t cmd;
-    pl_bool_t  success;
-    como_cmd_t errcmd;
+    struct sockaddr_un addr;
+    mode_t             mask;
+    int                fd, conn, ret;
+
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+    if ( strlen( path ) >= sizeof( addr.sun_path ) ) {
+        return -1;
+    }
+    strcpy( addr.sun_path, path );
 
-    /* Parse all arguments and fill information to options. */
+    fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( fd < 0 ) {
+        return -1;
+    }
 
-    como_cmd = como_main;
-    cmd = como_main;
+    /* Socket is accessible only to the owner. */
+    unlink( path );
+    mask = umask( 077 );
+    ret = bind( fd, (struct sockaddr*)&addr, sizeof( addr ) );
+    umask( mask );
+    if ( ret != 0 || chmod( path, S_IRUSR | S_IWUSR ) != 0 || listen( fd, 16 ) != 0 ) {
+        close( fd );
+        return -1;
+    }
 
-    success = setup_and_parse( cmd, &errcmd );
+    /* Client may leave before output is written. */
+    signal( SIGPIPE, SIG_IGN );
 
-    if ( !success ) {
-        como_cmd_usage( errcmd );
-        quit( EXIT_FAILURE );
-    } else if ( !check_missing( cmd, &errcmd ) ) {
-        como_cmd_usage( errcmd );
-        quit( EXIT_FAILURE );
-    } else {
-        usage_if_help( como_cmd );
+    serve_stop = pl_false;
+    while ( !serve_stop ) {
+        conn = accept( fd, NULL, NULL );
+        if ( conn < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            break;
+        }
+        serve_request( conn );
+        close( conn );
     }
+
+    close( fd );
+    unlink( path );
+
+    return serve_stop ? 0 : -1;
 }
 
 
-como_opt_t como_opt( char* name )
+void como_serve_stop( void )
 {
-    return find_opt_by_name( como_cmd, name );
+    serve_stop = pl_true;
 }
 
 
-char** como_value( char* name )
+int como_client( const char* path, int argc, char** argv )
 {
-    como_opt_t co;
-    co = find_opt_by_name( como_cmd, name );
-    return plcm_data( &co->value_store );
+    extern char**      environ;
+    struct sockaddr_un addr;
+    serve_req_s        req;
+    struct msghdr      msg;
+    struct iovec       iov;
+    struct cmsghdr*    cm;
+    char               ctrl[ CMSG_SPACE( 3 * sizeof( int ) ) ];
+    int                fds[ 3 ] = { 0, 1, 2 };
+    char               cwd[ 4096 ];
+    char *             payload, *pos;
+    pl_u64_t           size, len;
+    int                fd, i, status;
+
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+    if ( strlen( path ) >= sizeof( addr.sun_path ) ) {
+        return -1;
+    }
+    strcpy( addr.sun_path, path );
+
+    if ( !getcwd( cwd, sizeof( cwd ) ) ) {
+        strcpy( cwd, "/" );
+    }
+
+    /* Payload: cwd, argv, and env. */
+    req.magic = COMO_SERVE_MAGIC;
+    req.argc = argc;
+    req.envc = 0;
+    size = strlen( cwd ) + 1;
+    for ( i = 0; i < argc; i++ ) {
+        size += strlen( argv[ i ] ) + 1;
+    }
+    for ( char** e = environ; e && *e; e++ ) {
+        size += strlen( *e ) + 1;
+        req.envc++;
+    }
+    req.size = size;
+
+    payload = malloc( size );
+    if ( !payload ) {
+        return -1;
+    }
+    pos = payload;
+    len = strlen( cwd ) + 1;
+    memcpy( pos, cwd, len );
+    pos += len;
+    for ( i = 0; i < argc; i++ ) {
+        len = strlen( argv[ i ] ) + 1;
+        memcpy( pos, argv[ i ], len );
+        pos += len;
+    }
+    for ( char** e = environ; e && *e; e++ ) {
+        len = strlen( *e ) + 1;
+        memcpy( pos, *e, len );
+        pos += len;
+    }
+
+    fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( fd < 0 || connect( fd, (struct sockaddr*)&addr, sizeof( addr ) ) != 0 ) {
+        if ( fd >= 0 ) {
+            close( fd );
+        }
+        free( payload );
+        return -1;
+    }
+
+    /* Header with stdio fds. */
+    memset( &msg, 0, sizeof( msg ) );
+    memset( ctrl, 0, sizeof( ctrl ) );
+    iov.iov_base = &req;
+    iov.iov_len = sizeof( req );
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof( ctrl );
+    cm = CMSG_FIRSTHDR( &msg );
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN( sizeof( fds ) );
+    memcpy( CMSG_DATA( cm ), fds, sizeof( fds ) );
+
+    if ( sendmsg( fd, &msg, MSG_NOSIGNAL ) != sizeof( req ) || !write_full( fd, payload, size ) ||
+         !read_full( fd, &status, sizeof( status ) ) ) {
+        status = -1;
+    }
+
+    close( fd );
+    free( payload );
+
+    return status;
 }
 
 
-como_opt_t como_given( char* name )
+como_batch_t como_run_batch( const char* file, pl_i64_t threads )
 {
-    como_opt_t co;
-    co = find_opt_by_name( como_cmd, name );
-    if ( co->given ) {
-        return co;
-    } else {
+    FILE*          fh;
+    char*          line = NULL;
+    size_t         cap = 0;
+    char           line_mem_buf[ COMO_SERVE_MEM_SIZE ];
+    plam_s         line_mem;
+    plcm_s         jobs;
+    batch_job_t    job, *job_list;
+    batch_worker_s workers[ COMO_PAR_MAX_THREADS ];
+    como_batch_t   ret;
+    como_cmd_t     cmd;
+    char**         argv;
+    pl_i64_t       argc, cnt, i;
+
+    fh = fopen( file, "r" );
+    if ( !fh ) {
         return NULL;
     }
-}
 
+    /* Parse lines serially and export results for handlers. Jobs are
+       not moved, since output streams refer to them. */
+    plcm_empty( &jobs, 64 * sizeof( batch_job_t ) );
+    while ( getline( &line, &cap, fh ) >= 0 ) {
+
+        plam_use( &line_mem, line_mem_buf, COMO_SERVE_MEM_SIZE );
+        value_mem = &line_mem;
+
+        /* Line end is not part of (unterminated) quoted argument. */
+        line[ strcspn( line, "\r\n" ) ] = '\0';
+        argv = split_line( line, &line_mem, &argc );
+        if ( argc > 0 ) {
+            job = calloc( 1, sizeof( batch_job_s ) );
+            if ( job ) {
+                job->fh = open_memstream( &job->output, &job->outsize );
+            }
+            if ( !job || !job->fh ) {
+                /* Remaining lines are not run. */
+                como_fatal( "Out of memory for batch line!\n" );
+                free( job );
+                results_reset();
+                value_mem = &como_mem;
+                plam_del( &line_mem );
+                break;
+            }
+            plcm_store_ptr( &jobs, job );
+            out_fh = job->fh;
+            err_fh = job->fh;
+
+            if ( request_parse( argc, argv, &job->status ) ) {
+                cmd = request_handler( given_leaf( como_main ) );
+                if ( cmd ) {
+                    job->size = como_export( NULL, 0 );
+                    job->buf = malloc( job->size );
+                    if ( job->buf ) {
+                        job->fn = cmd->handler;
+                        job->arg = cmd->handler_arg;
+                        como_export( job->buf, job->size );
+                    } else {
+                        job->status = EXIT_FAILURE;
+                    }
+                } else {
+                    job->status = EXIT_FAILURE;
+                }
+            }
+
+            out_fh = NULL;
+            err_fh = NULL;
+        }
 
-como_opt_t como_cmd_opt( como_cmd_t cmd, char* name )
-{
-    return find_opt_by_name( cmd, name );
-}
+        results_reset();
+        value_mem = &como_mem;
+        plam_del( &line_mem );
+    }
+    free( line );
+    fclose( fh );
 
+    cnt = plcm_used_ptr( &jobs );
+    job_list = plcm_data( &jobs );
 
-char** como_cmd_value( como_cmd_t cmd, char* name )
-{
-    como_opt_t co;
-    co = find_opt_by_name( cmd, name );
-    return plcm_data( &co->value_store );
+    /* Run handlers, each worker starting with an equal range. */
+    if ( threads > COMO_PAR_MAX_THREADS ) {
+        threads = COMO_PAR_MAX_THREADS;
+    }
+    if ( threads < 1 ) {
+        threads = 1;
+    }
+    for ( i = 0; i < threads; i++ ) {
+        pthread_mutex_init( &workers[ i ].lock, NULL );
+        workers[ i ].beg = cnt * i / threads;
+        workers[ i ].end = cnt * ( i + 1 ) / threads;
+        workers[ i ].jobs = job_list;
+        workers[ i ].workers = workers;
+        workers[ i ].id = i;
+        workers[ i ].cnt = threads;
+    }
+
+    /* Calling thread is the first worker. */
+    for ( i = 1; i < threads; i++ ) {
+        if ( pthread_create( &workers[ i ].thread, NULL, batch_worker_run, &workers[ i ] ) != 0 ) {
+            /* Remaining ranges are stolen by running workers. */
+            workers[ i ].thread = 0;
+        }
+    }
+    batch_worker_run( &workers[ 0 ] );
+    for ( i = 1; i < threads; i++ ) {
+        if ( workers[ i ].thread ) {
+            pthread_join( workers[ i ].thread, NULL );
+        }
+    }
+    for ( i = 0; i < threads; i++ ) {
+        pthread_mutex_destroy( &workers[ i ].lock );
+    }
+
+    /* Collect results in input order. */
+    ret = malloc( sizeof( como_batch_s ) + cnt * ( sizeof( char* ) + sizeof( int ) ) );
+    if ( !ret ) {
+        for ( i = 0; i < cnt; i++ ) {
+            free( job_list[ i ]->output );
+            free( job_list[ i ] );
+        }
+        plcm_del( &jobs );
+        return NULL;
+    }
+    ret->cnt = cnt;
+    ret->output = (char**)( ret + 1 );
+    ret->status = (int*)( ret->output + cnt );
+    for ( i = 0; i < cnt; i++ ) {
+        ret->output[ i ] = job_list[ i ]->output;
+        ret->status[ i ] = job_list[ i ]->status;
+        free( job_list[ i ] );
+    }
+
+    plcm_del( &jobs );
+
+    return ret;
 }
 
 
-como_opt_t como_cmd_given( como_cmd_t cmd, char* name )
+void como_batch_end( como_batch_t batch )
 {
-    como_opt_t co;
-    co = find_opt_by_name( cmd, name );
-    if ( co->given ) {
-        return co;
-    } else {
-        return NULL;
+    for ( pl_i64_t i = 0; i < batch->cnt; i++ ) {
+        free( batch->output[ i ] );
     }
+    free( batch );
 }
 
 
-como_cmd_t como_cmd_subcmd( como_cmd_t cmd, char* name )
+FILE* como_out( void )
 {
-    como_cmd_t subcmd;
-
-    subcmd = plcm_data( &cmd->subcmds );
-    while ( (pl_t)subcmd < plcm_end( &cmd->subcmds ) ) {
-        if ( strcmp( subcmd->name, name ) == 0 ) {
-            return subcmd;
-        }
-        subcmd++;
-    }
-
-    return NULL;
+    return out_fh ? out_fh : stdout;
 }
 
 
-como_cmd_t como_given_subcmd( void )
+FILE* como_err( void )
 {
-    return como_cmd_given_subcmd( como_cmd );
+    return err_fh ? err_fh : stderr;
 }
 
 
-como_cmd_t como_cmd_given_subcmd( como_cmd_t parent )
+como_parse_t como_parse( como_parse_t prev, pl_i64_t argc, char** argv )
 {
-    como_cmd_p cmd;
+    parse_state_t ps = (parse_state_t)prev;
+    parse_step_t  step;
+    como_cmd_t    cmd;
+    como_cmd_p    c;
+    pl_i64_t      i, idx;
+    int           status;
+    FILE *        out_save, *err_save;
+
+    if ( !ps ) {
+        ps = calloc( 1, sizeof( parse_state_s ) );
+        if ( ps ) {
+            ps->membuf = malloc( COMO_SERVE_MEM_SIZE );
+        }
+        if ( ps && ps->membuf ) {
+            ps->fh = open_memstream( &ps->msgbuf, &ps->msgsize );
+        }
+        if ( !ps || !ps->fh ) {
+            como_fatal( "Out of memory for parse state!\n" );
+            if ( ps ) {
+                free( ps->membuf );
+            }
+            free( ps );
+            return NULL;
+        }
+        plam_use( &ps->mem, ps->membuf, COMO_SERVE_MEM_SIZE );
+    }
 
-    if ( plcm_is_empty( &parent->subcmds ) ) {
-        return NULL;
+    /* Program name is not parsed. */
+    argc--;
+    argv++;
+
+    /* First changed argument. */
+    for ( i = 0; i < argc && i < ps->argcnt && strcmp( argv[ i ], ps->args[ i ] ) == 0; i++ )
+        ;
+
+    /* Restore state at the last token boundary before change. */
+    step = journal_undo( ps, i );
+    if ( step ) {
+        /* Error count of failed command is set again if it fails. */
+        cmd = step->cmd;
+        idx = step->idx;
+        for ( c = plcm_data( &cmd_list ); (pl_t)c < plcm_end( &cmd_list ); c++ ) {
+            if ( *c != como_main ) {
+                ( *c )->errors = 0;
+            }
+        }
+    } else {
+        results_reset();
+        plam_del( &ps->mem );
+        plam_use( &ps->mem, ps->membuf, COMO_SERVE_MEM_SIZE );
+        cmd = como_main;
+        idx = 0;
     }
 
-    cmd = plcm_data( &parent->subcmds );
-    while ( (pl_t)cmd < plcm_end( &parent->subcmds ) ) {
-        if ( ( *cmd )->given ) {
-            return *cmd;
+    rewind( ps->fh );
+
+    if ( !parse_args_update( ps, i, argc, argv ) ) {
+        /* Next parse starts over. */
+        como_fatal( "Out of memory for parse arguments!\n" );
+        ps->stepcnt = 0;
+        ps->parse.status = EXIT_FAILURE;
+        idx = 0;
+    } else {
+        /* Parse the rest, and collect errors and usage. */
+        como_argc = argc;
+        como_argv = ps->args;
+        arg_idx = idx;
+        value_mem = &ps->mem;
+        out_save = out_fh;
+        err_save = err_fh;
+        out_fh = ps->fh;
+        err_fh = ps->fh;
+        parse_journal = ps;
+
+        if ( request_finish( cmd, &status ) ) {
+            ps->parse.status = EXIT_SUCCESS;
+        } else {
+            ps->parse.status = status;
         }
-        cmd++;
+
+        parse_journal = NULL;
+        out_fh = out_save;
+        err_fh = err_save;
+        value_mem = &como_mem;
     }
 
-    return NULL;
+    fputc( '\0', ps->fh );
+    fflush( ps->fh );
+    ps->parse.msg = ps->msgbuf;
+    ps->parse.reused = idx;
+
+    return &ps->parse;
 }
 
 
-char** como_external( void )
+void como_parse_end( como_parse_t parse )
 {
-    return como_main->external;
+    parse_state_t ps = (parse_state_t)parse;
+
+    if ( !ps ) {
+        return;
+    }
+
+    results_reset();
+    plam_del( &ps->mem );
+    for ( pl_i64_t i = 0; i < ps->argcnt; i++ ) {
+        free( ps->args[ i ] );
+    }
+    free( ps->args );
+    free( ps->steps );
+    free( ps->membuf );
+    fclose( ps->fh );
+    free( ps->msgbuf );
+    free( ps );
 }
 
 
-const char* como_opt_id( como_opt_t opt )
+int como_watch( const char* file, como_change_fn_t fn, void* arg )
 {
-    if ( opt->type != COMO_SUBCMD ) {
-        return opt->shortopt ? opt->shortopt : opt->longopt;
+    char        dir[ PATH_MAX ];
+    const char* slash;
+    como_snap_t snap;
+
+    /* One watcher at a time. Reload needs heap and results that can
+       be parsed (not frozen). */
+    if ( watch_fd >= 0 || fixed_mem || frozen_mem ) {
+        return -1;
+    }
+
+    watch_file = mem_store_string( file );
+    watch_fn = fn;
+    watch_arg = arg;
+    watch_argc = como_argc;
+    watch_argv = como_argv;
+    watch_stop = pl_false;
+
+    slash = strrchr( file, '/' );
+    if ( !slash ) {
+        strcpy( dir, "." );
+    } else if ( slash == file ) {
+        strcpy( dir, "/" );
     } else {
-        return opt->name;
+        snprintf( dir, sizeof( dir ), "%.*s", (int)( slash - file ), file );
     }
-}
 
+    watch_fd = inotify_init1( IN_CLOEXEC | IN_NONBLOCK );
+    if ( watch_fd < 0 ) {
+        return -1;
+    }
+    if ( inotify_add_watch( watch_fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE ) <
+         0 ) {
+        close( watch_fd );
+        watch_fd = -1;
+        return -1;
+    }
 
-/*
- * Functions to set configuration items.
- */
+    /* Command line results, then with initial file arguments (parsed
+       by watcher before watching). */
+    snap = snap_create( como_main );
+    if ( !snap ) {
+        close( watch_fd );
+        watch_fd = -1;
+        return -1;
+    }
+    snap_publish( snap );
+
+    watch_main = cmd_clone( como_main, NULL );
+    sem_init( &watch_ready, 0, 0 );
+    if ( pthread_create( &watch_thread, NULL, watch_run, NULL ) != 0 ) {
+        /* No thread to join. */
+        sem_destroy( &watch_ready );
+        watch_stop = pl_true;
+        como_watch_stop();
+        return -1;
+    }
+    while ( sem_wait( &watch_ready ) != 0 && errno == EINTR )
+        ;
+    sem_destroy( &watch_ready );
 
-void como_conf_autohelp( pl_bool_t val )
-{
-    como_cmd->conf->autohelp = val;
+    return 0;
 }
 
-void como_conf_header( char* val )
-{
-    como_cmd->conf->header = plam_store_string( &como_mem, val );
-}
 
-void como_conf_footer( char* val )
+void como_watch_stop( void )
 {
-    como_cmd->conf->footer = plam_store_string( &como_mem, val );
-}
+    if ( watch_fd < 0 ) {
+        return;
+    }
 
-void como_conf_subcheck( pl_bool_t val )
-{
-    como_cmd->conf->subcheck = val;
-}
+    if ( !__atomic_exchange_n( &watch_stop, pl_true, __ATOMIC_ACQ_REL ) ) {
+        pthread_join( watch_thread, NULL );
+    }
 
-void como_conf_check_missing( pl_bool_t val )
-{
-    como_cmd->conf->check_missing = val;
+    close( watch_fd );
+    watch_fd = -1;
+    snap_publish( NULL );
 }
 
-void como_conf_check_invalid( pl_bool_t val )
-{
-    como_cmd->conf->check_invalid = val;
-}
 
-void como_conf_tab( pl_i64_t val )
+como_snap_t como_snap_get( void )
 {
-    como_cmd->conf->tab = val;
+    como_snap_t snap;
+    pl_u64_t    epoch;
+
+    /* Enter epoch, which is unchanged after entering. */
+    for ( ;; ) {
+        epoch = __atomic_load_n( &snap_epoch, __ATOMIC_SEQ_CST );
+        __atomic_add_fetch( &snap_readers[ epoch & 1 ], 1, __ATOMIC_SEQ_CST );
+        if ( __atomic_load_n( &snap_epoch, __ATOMIC_SEQ_CST ) == epoch ) {
+            break;
+        }
+        __atomic_sub_fetch( &snap_readers[ epoch & 1 ], 1, __ATOMIC_SEQ_CST );
+    }
+
+    snap = __atomic_load_n( &snap_current, __ATOMIC_SEQ_CST );
+    if ( snap ) {
+        __atomic_add_fetch( &snap->refcnt, 1, __ATOMIC_SEQ_CST );
+    }
+
+    __atomic_sub_fetch( &snap_readers[ epoch & 1 ], 1, __ATOMIC_SEQ_CST );
+
+    return snap;
 }
 
-void como_conf_help_exit( pl_bool_t val )
+
+void como_snap_put( como_snap_t snap )
 {
-    como_cmd->conf->help_exit = val;
+    if ( snap && __atomic_sub_fetch( &snap->refcnt, 1, __ATOMIC_ACQ_REL ) == 0 ) {
+        free( snap->cmd );
+        free( snap );
+    }
 }
 
 
-void como_error( const char* format, ... )
+void como_use_mem( void* buf, pl_i64_t size )
 {
-    como_cmd->errors++;
-
-    va_list ap;
-    fputc( '\n', stderr );
-    fputs( como_cmd->name, stderr );
-    fputs( " error: ", stderr );
-    va_start( ap, format );
-    vfprintf( stderr, format, ap );
-    va_end( ap );
-    fputc( '\n', stderr );
+    fixed_mem = buf;
+    fixed_size = size;
+    fixed_used = 0;
 }
 
 
-void como_usage( void )
+pl_i64_t como_used_mem( void )
 {
-    como_cmd_usage( como_cmd );
+    return fixed_used;
 }
 
 
-void como_cmd_usage( como_cmd_t cmd )
+/**
+ * Compute upper bound of memory required for command (see:
+ * como_required_mem()).
+ *
+ * @param spec Array of option specifications.
+ * @param size Size of the specification array.
+ * @param argc C-main argument count.
+ * @param args Include per argument memory (once per command set).
+ *
+ * @return Required bytes.
+ */
+static pl_u64_t spec_required_mem( const como_opt_spec_s* spec,
+                                   pl_i64_t               size,
+                                   pl_i64_t               argc,
+                                   pl_bool_t              args )
 {
-    plcm_t str;
+    const como_opt_spec_s* ts;
+    pl_u64_t               optcnt, mem, ptrs, usage, idlen, namelen, slots, buckets, argn;
 
-    como_opt_p co;
-    pl_bool_t  main_cmd, has_visible;
+    /* Automatic help is included. */
+    optcnt = size + 1;
 
-    plcm_declare( str_handle, 8192 );
-    str = &str_handle;
+    /* Command, configuration (and own copy), options, keys, and bits. */
+    mem = mem_align( sizeof( como_cmd_s ) ) + 2 * mem_align( sizeof( como_config_s ) ) +
+          mem_align( ( optcnt + 1 ) * sizeof( como_opt_t ) ) +
+          mem_align( optcnt * sizeof( como_opt_s ) ) + mem_align( keys_size( optcnt ) ) +
+          mem_align( 3 * ( ( optcnt + 63 ) / 64 ) * sizeof( pl_u64_t ) );
 
-    if ( cmd->conf->header ) {
-        plss_format_string( str, "%s", cmd->conf->header );
-    } else {
-        plss_append_char( str, '\n' );
-    }
+    /* Arguments are values of one command at most. */
+    argn = args ? argc : 0;
 
-    if ( !cmd->parent ) {
-        /* Main command. */
-        main_cmd = pl_true;
-    } else {
-        /* Subcmd. */
-        main_cmd = pl_false;
-    }
+    /* Pointer arrays double in size, and previous arrays are not
+     * released. Values: 4 per argument and 12 per option. Command
+     * lists: 48 per command and 4 per subcmd. Argv: argc. */
+    ptrs = 4 * argn + 12 * optcnt + 48 + 4 * size + argn;
 
+    /* Value lengths: one per argument, and alignment per option. */
+    mem += ( argn + optcnt ) * sizeof( pl_size_t );
 
-    if ( main_cmd ) {
-        plss_format_string( str, "  %s", cmd->name );
-    } else {
-        plss_format_string( str, "  Subcommand \"%s\" usage:\n    ", cmd->name );
-        plss_format_string( str, "%s", cmd->longname );
-    }
+    /* Argument classes and lengths. */
+    mem += mem_align( argn * sizeof( pl_u32_t ) ) + mem_align( argn );
 
-    /* Command line. */
-    has_visible = pl_false;
-    co = cmd->opts;
-    while ( *co ) {
-        if ( !( ( *co )->type & COMO_P_HIDDEN ) ) {
+    /* Occurrences (at most one per argument): per argument option and
+     * value range, and occurrence arrays with order. */
+    mem += mem_align( argn * sizeof( como_opt_t ) ) + 2 * mem_align( argn * sizeof( pl_u32_t ) ) +
+           mem_align( argn * sizeof( como_occur_s ) ) + mem_align( argn * sizeof( como_occur_t ) );
 
-            has_visible = pl_true;
+    usage = 256 + opt_usage_size( 6, 4, como_help_spec.doc, COMO_MEM_TAB );
 
-            plss_append_char( str, ' ' );
-            if ( ( *co )->type != COMO_SUBCMD ) {
-                opt_cmdline( str, *co );
+    for ( pl_i64_t i = 0; i < size; i++ ) {
+        ts = &spec[ i ];
+
+        /* Side entry and validator (check or user function), and
+         * suggestion nodes for long and short switch. */
+        mem += mem_align( sizeof( como_opt_ext_s ) ) + mem_align( sizeof( como_valid_s ) ) +
+               2 * mem_align( sizeof( como_bknode_s ) );
+
+        if ( ts->type == COMO_DEFAULT ) {
+            idlen = 9;
+            namelen = 9;
+        } else {
+            namelen = text_len( ts->name );
+            if ( ts->type == COMO_SUBCMD ) {
+                idlen = namelen;
+            } else if ( ts->opt ) {
+                idlen = text_len( ts->opt );
             } else {
-                plss_append_string( str, "<<subcommand>>" );
-                break;
+                idlen = ts->longopt ? text_len( ts->longopt ) : namelen + 2;
             }
         }
-        co++;
-    }
-
-    plss_append_string( str, "\n\n" );
-
-    /* If cmd has subcmds, use categories: Options, Subcommands. */
-
-    if ( !plcm_is_empty( &cmd->subcmds ) && has_visible ) {
-        plss_append_string( str, "  Options:\n" );
-    }
 
-    /* Option documents. */
-    co = cmd->opts;
-    while ( *co ) {
-        if ( ( *co )->type != COMO_SUBCMD ) {
-            opt_doc( str, *co, cmd );
+        if ( !ts->longopt ) {
+            mem += mem_align( namelen + 3 );
         }
-        co++;
-    }
-
-    if ( !plcm_is_empty( &cmd->subcmds ) ) {
-        plss_append_string( str, "\n  Subcommands:\n" );
-    }
 
-    /* Subcmd documents. */
-    co = cmd->opts;
-    while ( *co ) {
-        if ( ( *co )->type == COMO_SUBCMD ) {
-            opt_doc( str, *co, cmd );
+        if ( ts->type & ( COMO_MAP | COMO_P_MAP ) ) {
+            /* Table of at least 4 slots, and at most 4 per argument. */
+            mem += mem_align( sizeof( como_map_s ) ) +
+                   ( 4 + 4 * argc ) * sizeof( como_map_entry_s );
         }
-        co++;
-    }
 
-    if ( main_cmd ) {
-        plss_format_string( str, "\n\n  Copyright (c) %s by %s\n", cmd->year, cmd->author );
-    } else {
-        plss_append_string( str, "\n" );
-    }
+        if ( ts->check ) {
+            mem += mem_align( sizeof( check_comp_s ) );
+            if ( ts->check->kind == COMO_CHECK_KIND_ENUM ) {
+                mem += check_enum_size( check_enum_count( ts->check->set ), &slots, &buckets );
+            }
+        }
 
-    if ( cmd->conf->footer ) {
-        plss_format_string( str, "%s", cmd->conf->footer );
-    } else {
-        plss_append_char( str, '\n' );
+        usage += opt_usage_size( idlen, namelen, ts->doc, COMO_MEM_TAB );
     }
 
-    fprintf( stdout, plss_string( str ) );
+    return mem + ptrs * sizeof( char* ) + usage + COMO_MEM_RESERVE;
+}
 
-    plcm_del( str );
 
-    if ( cmd->conf->help_exit ) {
-        quit( EXIT_FAILURE );
-    }
+pl_i64_t como_required_mem( const como_opt_spec_s* spec, pl_i64_t size, pl_i64_t argc )
+{
+    return spec_required_mem( spec, size, argc, pl_true );
 }
 
 
-void como_display_values( FILE* fh, como_opt_t o )
+pl_i64_t como_required_mem_cmds( const como_cmd_spec_s* cmds, pl_i64_t cnt, pl_i64_t argc )
 {
-    char**    value;
-    pl_bool_t first = pl_true;
+    pl_u64_t mem = 0;
 
-    if ( ( o->type & COMO_P_MANY ) || ( o->type & COMO_P_DEFAULT ) ) {
-        fprintf( fh, "[" );
-        value = plcm_data( &o->value_store );
-        while ( *value ) {
-            if ( !first ) {
-                fprintf( fh, ", " );
-            }
-            fprintf( fh, "\"%s\"", *value );
-            first = pl_false;
-            value++;
-        }
-        fprintf( fh, "]" );
-    } else {
-        value = plcm_data( &o->value_store );
-        fprintf( fh, "%s", *value );
+    for ( pl_i64_t i = 0; i < cnt; i++ ) {
+        mem += spec_required_mem( cmds[ i ].spec, cmds[ i ].size, argc, i == 0 );
     }
+
+    return mem;
 }
 
 
@@ -1159,34 +6716,42 @@ void como_init( pl_i64_t argc, char** argv, char* author, char* year )
     arg_idx = 0;
     como_argc = argc - 1;
 
-    plam_use( &como_mem, como_init_mem, COMO_INIT_MEM_SIZE );
+    if ( fixed_mem ) {
+        fixed_used = 0;
+    } else {
+        plam_use( &como_mem, como_init_mem, COMO_INIT_MEM_SIZE );
+    }
 
     /* Null-terminate como_argv. */
-    como_argv = plam_get( &como_mem, ( como_argc + 1 ) * sizeof( char* ) );
+    como_argv = mem_get( ( como_argc + 1 ) * sizeof( char* ) );
     for ( i = 0; i < como_argc; i++ ) {
         como_argv[ i ] = argv[ i + 1 ];
     }
     como_argv[ i ] = NULL;
 
-    plcm_use_plam( &cmd_list, &como_mem, 16 * sizeof( como_cmd_s ) );
+    if ( fixed_mem ) {
+        memset( &cmd_list, 0, sizeof( plcm_s ) );
+    } else {
+        plcm_use_plam( &cmd_list, &como_mem, 16 * sizeof( como_cmd_t ) );
+    }
 
     como_cmd = cmd_create();
 
-    como_cmd->author = plam_store_string( &como_mem, author );
-    como_cmd->year = plam_store_string( &como_mem, year );
+    como_cmd->author = mem_store_string( author );
+    como_cmd->year = mem_store_string( year );
 
     como_cmd->conf = config_create();
     como_conf = como_cmd->conf;
 }
 
 
-void como_spec_subcmd( char* name, char* parentname, como_opt_spec_t spec, pl_i64_t size )
+void como_spec_subcmd( char*                  name,
+                       char*                  parentname,
+                       const como_opt_spec_s* spec,
+                       pl_i64_t               size )
 {
-    como_opt_spec_t ts;
-    como_opt_p      opts;
-    como_cmd_t      cmd;
-    pl_i64_t        i, i2;
-    como_cmd_t      parent;
+    como_cmd_t cmd;
+    como_cmd_t parent;
 
     if ( !parentname ) {
         /* Main cmd, i.e. como_cmd_s is already initially setup. */
@@ -1195,74 +6760,111 @@ void como_spec_subcmd( char* name, char* parentname, como_opt_spec_t spec, pl_i6
         cmd->conf = como_conf;
 
         /* For main both names are the same. */
-        cmd->name = plam_store_string( &como_mem, name );
-        cmd->longname = plam_store_string( &como_mem, name );
+        cmd->name = mem_store_string( name );
+        cmd->longname = mem_store_string( name );
     } else {
-        cmd = cmd_create();
         parent = find_cmd_by_name( parentname );
         if ( !parent ) {
             como_fatal( "Parent \"%s\" does not exist!", parentname );
+            return;
         }
+        cmd = cmd_create();
         cmd->parent = parent;
-        // register_cmd( cmd );
         add_subcmd( parent, cmd );
-        cmd->conf = config_dup( parent->conf );
+        cmd->conf = config_share( parent->conf );
 
         /* For subcmd both longname is based on its ancestors. */
-        cmd->name = plam_store_string( &como_mem, name );
-        cmd->longname = plam_format_string( &como_mem, "%s %s", parent->longname, name );
+        cmd->name = mem_store_string( name );
+        cmd->longname = mem_format_string( "%s %s", parent->longname, name );
     }
 
-    cmd->optcnt = size;
+    /* Options are created when command is used. */
+    cmd->spec = spec;
+    cmd->specsize = size;
+    cmd->image = NULL;
+    cmd->optcnt = 0;
 
-    if ( cmd->conf->autohelp ) {
-        /* Add space for help. */
-        cmd->optcnt++;
-    }
+    /* Configuration applies to latest command. */
+    como_cmd = cmd;
+}
 
-    /* optcnt + NULL. */
-    opts = plam_get( &como_mem, ( cmd->optcnt + 1 ) * sizeof( como_opt_t ) );
 
-    /* Insert help. */
-    i = 0;
-    if ( cmd->conf->autohelp ) {
-        opts[ i ] = opt_create( COMO_SILENT, "help", "-h", "Display usage info." );
-        opts[ i ]->type |= COMO_P_MUTEX;
-        i++;
-    }
+void como_spec_subcmd_copy( char*                  name,
+                            char*                  parentname,
+                            const como_opt_spec_s* spec,
+                            pl_i64_t               size )
+{
+    como_opt_spec_s* copy;
 
-    /* Create options (after help). */
-    i2 = 0;
-    while ( i < cmd->optcnt ) {
-        ts = &spec[ i2 ];
-        opts[ i ] = opt_create( ts->type, ts->name, ts->opt, ts->doc );
-        i++;
-        i2++;
+    copy = mem_get( size * sizeof( como_opt_spec_s ) );
+    memcpy( copy, spec, size * sizeof( como_opt_spec_s ) );
+    como_spec_subcmd( name, parentname, copy, size );
+}
+
+
+void como_plugin( char* name, char* parentname, const char* path )
+{
+    if ( !parentname ) {
+        como_fatal( "Plugin \"%s\" must be a subcommand!\n", name );
+        return;
     }
-    opts[ i ] = NULL;
 
-    cmd->opts = opts;
+    /* Specification is taken from plugin when command is used. */
+    como_spec_subcmd( name, parentname, NULL, 0 );
+    como_cmd->plugin = mem_store_string( path );
 }
 
 
 void como_cmd_end( como_cmd_t cmd )
 {
+    if ( !cmd->opts ) {
+        return;
+    }
+
     for ( pl_u64_t i = 0; i < cmd->optcnt; i++ ) {
-        plcm_del( &cmd->opts[ i ]->value_store );
+        if ( plcm_data( &cmd->opts[ i ]->value_store ) ) {
+            plcm_del( &cmd->opts[ i ]->value_store );
+        }
+    }
+    if ( plcm_data( &cmd->subcmds ) ) {
+        plcm_del( &cmd->subcmds );
     }
-    plcm_del( &cmd->subcmds );
 }
 
 
 void como_end( void )
 {
-    como_cmd_t cmd;
+    como_cmd_p cmd;
 
     cmd = plcm_data( &cmd_list );
     while ( (pl_t)cmd < plcm_end( &cmd_list ) ) {
-        como_cmd_end( cmd );
+        como_cmd_end( *cmd );
+        if ( ( *cmd )->plugin_handle ) {
+            dlclose( ( *cmd )->plugin_handle );
+        }
         cmd++;
     }
     plcm_del( &cmd_list );
-    plam_del( &como_mem );
+
+    args_release();
+
+    if ( spec_image ) {
+        munmap( spec_image, spec_image_size );
+        spec_image = NULL;
+        spec_image_size = 0;
+    }
+
+    if ( frozen_mem ) {
+        munmap( frozen_mem, frozen_size );
+        frozen_mem = NULL;
+        frozen_size = 0;
+    }
+
+    if ( fixed_mem ) {
+        fixed_mem = NULL;
+        fixed_size = 0;
+        fixed_used = 0;
+    } else {
+        plam_del( &como_mem );
+    }
 }
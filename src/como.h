@@ -90,6 +90,15 @@
  * form is replaced with "NULL", the long option format is only
  * available.
  *
+ * Option table can also be a static const array, which is used in
+ * place. "COMO_OPT" macro generates the long option at compile time:
+ * @code
+ *   static const como_opt_spec_s spec[] = {
+ *       COMO_OPT( COMO_SINGLE, file, "-f", "File argument." ),
+ *       COMO_OPT( COMO_SWITCH, debug, "-d", "Enable debugging." ),
+ *   };
+ * @endcode
+ *
  * Doc includes documentation for the option. It is displayed when
  * "help" ("-h") option is given. Help option is added to the command
  * automatically as default behavior.
@@ -268,6 +277,11 @@
  * - COMO_SILENT: Option that does not coexist with other options and is not
  *           displayed as an option in Usage Help display. In effect a
  *           sub-option of :exclusive.
+ * - COMO_MAP: Optional multiple argument option with "key=value"
+ *           arguments. Values in array and in hash table (see:
+ *           como_map_get()).
+ * - COMO_COUNT: Switch option that can be repeated. Number of
+ *           occurrences is the count (see: como_count()).
  *
  * Options use all the 4 option fields:
  * @code
@@ -306,6 +320,8 @@
  * - COMO_P_DEFAULT: Default option.
  * - COMO_P_MUTEX: Mutually exclusive option.
  * - COMO_P_HIDDEN: Hidden option (no usage doc).
+ * - COMO_P_MAP: Key=value argument(s) in hash table.
+ * - COMO_P_COUNT: Repeatable switch.
  *
  * Types to primitives mapping:
  *
@@ -319,6 +335,8 @@
  * - COMO_EXCLUSIVE: COMO_P_NONE, COMO_P_ONE, COMO_P_MANY, COMO_P_OPT, COMO_P_MUTEX
  * - COMO_PRIORITY: COMO_P_NONE, COMO_P_ONE, COMO_P_MANY, COMO_P_OPT, COMO_P_MUTEX
  * - COMO_SILENT: COMO_P_NONE, COMO_P_OPT, COMO_P_HIDDEN
+ * - COMO_MAP: COMO_P_ONE, COMO_P_MANY, COMO_P_OPT, COMO_P_MAP
+ * - COMO_COUNT: COMO_P_NONE, COMO_P_OPT, COMO_P_COUNT
  *
  * Primitives can be used in place of types if exotic options are
  * needed. Instead of a single type, ored combination of primitives
@@ -340,10 +358,11 @@
  * The configuration options are set by execution configuration
  * function. These are the called after option has been specified and
  * before como_finish. Setting the configuration at "como_maincmd"
- * will propagate the config options to all the subcommands as
- * well. Configuration can be given to each subcommand separately to
- * override the inherited config values. Subcommand settings are not
- * inherited, but apply only in the subcommand.
+ * will propagate the config options to all the subcommands as well
+ * (config is shared until modified). Configuration can be given to
+ * each subcommand separately to override the inherited config
+ * values. Subcommand settings are not inherited by the parent, but
+ * apply only in the subcommand (and its subcommands).
  *
  * The usable configuration keys:
  * - autohelp: Add help option automatically (default: true). Custom
@@ -354,10 +373,121 @@
  * - subcheck: Automatically check that a subcommand is provided
  *             (default: true).
  * - check_missing: Check for missing arguments (default: true).
- * - check_invalid: Error for unknown options (default: true).
+ * - check_invalid: Error for unknown options (default: true). Error
+ *                  suggests the nearest option switches (or subcmd
+ *                  names), i.e. names within edit distance of third
+ *                  of the unknown name length.
  * - tab: Tab stop column for option documentation (default: 12).
  * - help_exit: Exit program if help displayed (default: true).
+ * - map_dup: Duplicate key policy for map options:
+ *            COMO_MAP_DUP_LAST (default), COMO_MAP_DUP_FIRST, or
+ *            COMO_MAP_DUP_ERROR.
+ * - threads: Number of threads for option value validation
+ *            (default: 1). Read from the main command.
+ *
+ * Configuration functions apply to the most recently specified
+ * command.
+ *
+ *
+ * ### Option value validation
+ *
+ * Option values can be checked with validator functions. Validator
+ * is attached to an option (of the most recently specified command)
+ * with:
+ * @code
+ *   como_conf_validator( "count", como_valid_integer, NULL );
+ * @endcode
+ *
+ * Values are validated as they are parsed. Invalid value is reported
+ * and usage is displayed.
+ *
+ * When "threads" config is larger than one, validation is deferred
+ * after parsing and performed by a worker pool (if the command line
+ * has a lot of option values). This is beneficial for very large
+ * COMO_MULTI and COMO_DEFAULT value lists. Invalid values are
+ * reported in command line order.
+ *
+ * Predefined validators:
+ * - como_valid_integer: Integer value (arg: NULL).
+ * - como_valid_path: Existing path (arg: NULL or pointer to access()
+ *                    mode).
+ * - como_valid_regex: Value matches regexp (arg: compiled regex_t
+ *                     pointer).
+ *
+ * Common checks can be given declaratively as the fifth field of the
+ * option specification:
+ * @code
+ *   { COMO_SINGLE, "level", "-l", "Level.", COMO_CHECK_ENUM( "low", "high" ) },
+ *   { COMO_MULTI, "count", "-c", "Counts.", COMO_CHECK_RANGE( 1, 100 ) },
+ * @endcode
+ *
+ * Checks are compiled once per command (enum sets are stored as
+ * perfect hash tables) and values are checked as they are parsed.
+ * Invalid value is reported with its argument position.
+ *
+ * Declarative checks:
+ * - COMO_CHECK_ENUM( ... ): Value is one of the listed strings.
+ * - COMO_CHECK_RANGE( min, max ): Integer value within range.
+ * - COMO_CHECK_SIZE( min, max ): Size value with optional K, M, G, or
+ *                                T suffix (optionally followed by
+ *                                "B"). Range in bytes.
+ * - COMO_CHECK_DURATION( min, max ): Duration value with optional ms,
+ *                                    s, m, h, or d suffix (default:
+ *                                    s). Range in milliseconds.
+ * - COMO_CHECK_REGEX( pattern ): Value matches extended regexp.
+ *
+ *
+ * ### Option constraints
+ *
+ * Relations between options of a command are specified with rules
+ * (for the most recently specified command):
+ * @code
+ *   como_rule_requires( "user", "password" );
+ *   como_rule_conflicts( "quiet", "verbose", "debug" );
+ *   como_rule_at_most_one( "tar", "zip", "gzip" );
+ *   como_rule_at_least_one( "file", "url" );
+ * @endcode
+ *
+ * Rules are compiled to option bitmasks, and they are checked against
+ * the set of given options after parsing (together with the
+ * mandatory options, when "check_missing" is enabled). Rules are not
+ * checked if an exclusive option, e.g. "help", is given.
+ *
+ *
+ *
+ * ## Result struct
+ *
+ * Options can be declared once as X-macro list, which is used to
+ * generate the specification table and a plain C struct for the
+ * results:
+ * @code
+ *   #define PROG_OPTS( X )                                       \
+ *       X( COMO_OPT_SINGLE, int64_t,     threads, "-t", "Threads." ) \
+ *       X( COMO_OPT_SINGLE, const char*, file,    "-f", "File." )    \
+ *       X( COMO_SWITCH,     _Bool,       debug,   "-d", "Debug." )
+ *
+ *   COMO_STRUCT( prog_opts, PROG_OPTS )
+ *
+ *   prog_opts_s opts = { .threads = 1 };
+ *
+ *   como_init( argc, argv, "Me", "2013" );
+ *   como_subcmd_table( "prog", NULL, prog_opts_spec );
+ *   prog_opts_bind( &opts );
+ *   como_finish();
+ * @endcode
  *
+ * The struct is filled during parsing, i.e. option values are
+ * converted as they are parsed. Fields of options that are not given
+ * keep their initial values. Invalid value for the field type is an
+ * error.
+ *
+ * Field types:
+ * - _Bool: Option given.
+ * - int, int64_t: Integer value (or one for given switch, or count
+ *   for COMO_COUNT).
+ * - double: Floating point value.
+ * - char*, const char*: Value (last value for multi-options).
+ * - char**: NULL terminated list of values.
  *
  *
  * ## Option referencing
@@ -395,10 +525,64 @@
  * Then check how many arguments where given, and finally decide what
  * to do. The value array is terminated with NULL.
  *
+ * "COMO_MAP" values ("key=value") are also collected to a hash table,
+ * and values are queried by key:
+ * @code
+ *   const char* size = como_map_get( como_opt( "params" ), "size" );
+ * @endcode
+ * Keys and values refer to the command line arguments (no copies),
+ * hence keys are not null terminated in the table (see:
+ * como_map_entry_s). Duplicate keys are handled according to
+ * "map_dup" configuration.
+ *
+ * Every occurrence of an option is recorded in "occur" of the option
+ * (argument index and value range). Occurrences of all options of a
+ * command are iterated in command line order with:
+ * @code
+ *   como_iter_s it;
+ *   como_iter_init( &it, cmd );
+ *   while ( como_iter_next( &it ) ) {
+ *       // it.opt, it.occur, and it.opt->value[ it.occur->value ].
+ *   }
+ * @endcode
+ *
  * Header file "como.h" includes user definitions and documentation
  * for user interface functions.
  *
  *
+ * ### Option handles
+ *
+ * Name based queries search the option by name. Options can also be
+ * referenced with handles, which make the queries plain array
+ * indexing. Handle is the index of the option in the specification,
+ * hence handles can be defined as enum in specification order:
+ * @code
+ *   enum { OPT_FILE, OPT_DEBUG };
+ *
+ *   como_maincmd( "prog", "Me", "2013",
+ *                 { COMO_SINGLE, "file",  "-f", "File." },
+ *                 { COMO_SWITCH, "debug", "-d", "Debug." } );
+ *   como_finish();
+ *
+ *   if ( como_given_at( OPT_DEBUG ) ) ...
+ * @endcode
+ *
+ * Options declared with X-macro list (see: Result struct) have
+ * generated handles, e.g. COMO_HANDLE( prog_opts, debug ).
+ *
+ * Handle for the automatic help option is COMO_HELP_HANDLE. Handle
+ * accessors return NULL for handles out of range (e.g. help handle
+ * when autohelp is disabled). Dynamic callers resolve handles for a
+ * set of names once:
+ * @code
+ *   const char*   names[] = { "file", "debug" };
+ *   como_handle_t handles[ 2 ];
+ *   como_resolve( cmd, names, handles, 2 );
+ *   ...
+ *   value = como_cmd_value_at( cmd, handles[ 0 ] );
+ * @endcode
+ *
+ *
  * ### Subcommand options
  *
  * The given subcommand for the parent command is return by
@@ -413,6 +597,286 @@
  * that option is stored as an array to "como_external".
  *
  *
+ * ### Frozen results
+ *
+ * Long running programs can compact the results after parsing with
+ * como_freeze(). Results are copied to one compact block, and the
+ * memory used for specification and parsing is released. Options and
+ * values are read-only, and their pages remain shared with children
+ * after fork. Commands and configuration remain writable, hence
+ * como_error(), como_usage(), and como_conf_* functions can be used.
+ *
+ *
+ * ### Spec cache
+ *
+ * Program with a large command tree can store the specification to a
+ * file once, and map it on later starts instead of specifying the
+ * commands again:
+ * @code
+ *   como_init( argc, argv, "Me", "2013" );
+ *   if ( como_spec_load( "/var/cache/admin.spec", ADMIN_VERSION ) != 0 ) {
+ *       specify_commands();
+ *       como_spec_save( "/var/cache/admin.spec", ADMIN_VERSION );
+ *   }
+ *   como_finish();
+ * @endcode
+ *
+ * Key identifies the specification (e.g. program version or build
+ * id), and cache with other key is stale and not loaded. Cache files
+ * are validated, and invalid files are not loaded.
+ *
+ * Cache includes commands, options, and configuration, but not value
+ * checks, rules, bindings, or handlers. These can be set after loading
+ * as usual.
+ *
+ *
+ * ### Plugin subcommands
+ *
+ * Subcommand can be provided by a shared object, which is loaded only
+ * when the subcommand is used (parsed, or its usage displayed). Parent
+ * specification includes the subcommand with its doc as usual, and
+ * the plugin is declared with its path:
+ * @code
+ *   como_maincmd( "tool", "Me", "2013",
+ *                 { COMO_SUBCMD, "db", NULL, "Database tools." } );
+ *   como_plugin( "db", "tool", "/usr/lib/tool/db.so" );
+ * @endcode
+ *
+ * Plugin defines its options and (optional) handler with:
+ * @code
+ *   como_plugin_define( db_handler,
+ *                       { COMO_SWITCH, "vacuum", "-v", "Vacuum." } );
+ * @endcode
+ *
+ * Plugin that fails to load is reported, and it has no options.
+ *
+ * Plugin uses como from the host program, and it is loaded with
+ * RTLD_NOW, so como symbols must be visible to it. Either link como
+ * into the program with -rdynamic (plugin is built with -shared and
+ * -fPIC, leaving como symbols undefined), or link both the program and
+ * the plugin against a shared libcomo.so. Otherwise loading fails with
+ * "undefined symbol".
+ *
+ *
+ * ## Server mode
+ *
+ * Short running programs can be served by a resident process, in
+ * order to avoid the program startup cost. Server specifies the
+ * commands as usual, registers handlers for commands, and calls
+ * como_serve() instead of como_finish():
+ * @code
+ *   como_maincmd( "admin", "Me", "2013",
+ *                 { COMO_SUBCMD, "status", NULL, "Show status." } );
+ *   como_subcmd( "status", "admin",
+ *                { COMO_SWITCH, "verbose", "-v", "Verbose." } );
+ *   como_handler( status_handler, NULL );
+ *   como_serve( "/tmp/admin.sock" );
+ * @endcode
+ *
+ * Client forwards its command line to the server:
+ * @code
+ *   int main( int argc, char** argv )
+ *   {
+ *       return como_client( "/tmp/admin.sock", argc, argv );
+ *   }
+ * @endcode
+ *
+ * Client's stdin, stdout, and stderr are passed to the server
+ * (SCM_RIGHTS), and server uses them together with client's working
+ * directory and environment while handling the request. Hence help,
+ * errors, and handler output go to the client. Handler return value
+ * is the exit status of the client. Requests are served one at a time.
+ *
+ * Errors and help do not exit the server, they just end the request.
+ *
+ * Socket is created with owner only access, and clients of other
+ * users (except root) are rejected. Malformed requests are dropped
+ * without reply.
+ *
+ *
+ * ## Batch mode
+ *
+ * Command lines can be run from a file, one command line per line,
+ * without starting a process for each line:
+ * @code
+ *   como_batch_t batch;
+ *
+ *   batch = como_run_batch( "commands.txt", 8 );
+ *   for ( pl_i64_t i = 0; i < batch->cnt; i++ ) {
+ *       fputs( batch->output[ i ], stdout );
+ *   }
+ *   como_batch_end( batch );
+ * @endcode
+ *
+ * Lines are split to arguments like in the shell (quotes and
+ * backslash escapes), and the first argument is the program name.
+ * Empty lines and comments ("#") are skipped.
+ *
+ * Lines are parsed serially, and the handlers are run by a work
+ * stealing worker pool. Each handler gets a private copy of the parse
+ * results (see: como_export()). Queries without command argument
+ * (e.g. como_given(), como_value()) and como_error() refer to the
+ * private results within handler, but como_cmd and como_main do not.
+ * Handlers must write to como_out() (and como_err()), which are
+ * collected per line and returned in input order.
+ *
+ *
+ *
+ * ## Hot reload
+ *
+ * Long running programs can take additional arguments from a file,
+ * which is watched (inotify) for changes:
+ * @code
+ *   como_command( ... );
+ *   como_watch( "/etc/prog.args", changed, NULL );
+ *
+ *   for ( ;; ) {
+ *       como_snap_t snap = como_snap_get();
+ *       ... como_cmd_given( snap->cmd, "verbose" ) ...
+ *       como_snap_put( snap );
+ *   }
+ * @endcode
+ *
+ * File arguments are split like batch lines (one or more lines), and
+ * they are placed before the command line arguments, i.e. they are
+ * main command options.
+ *
+ * On change the command line is parsed again in the watcher thread,
+ * to a private copy of the command hierarchy, and the results are
+ * published as a new snapshot (see: como_export()). Program's own
+ * results (como_opt() etc.) and bound result fields are not changed.
+ * Snapshot is taken without locks. Previous snapshot is released
+ * after a grace period, in which the readers that might have seen it
+ * have taken their reference, and after the last reader has put it
+ * back. If parsing fails, the errors are reported to stderr and the
+ * previous snapshot remains.
+ *
+ * Change callback is called (in watcher thread) for each option that
+ * differs from the previous snapshot (given status or values). The
+ * initial file contents are applied in como_watch(), and reported as
+ * changes to the command line results.
+ *
+ *
+ * ## Incremental parsing
+ *
+ * Interactive front ends (completion, hints) parse a command line
+ * again after each edit. With como_parse() the previous result is
+ * reused up to the first changed argument:
+ * @code
+ *   como_parse_t parse = NULL;
+ *
+ *   for ( ;; ) {
+ *       ... edit line, split to argc and argv ...
+ *       parse = como_parse( parse, argc, argv );
+ *       if ( parse->status != 0 ) {
+ *           show_hint( parse->msg );
+ *       }
+ *   }
+ *   como_parse_end( parse );
+ * @endcode
+ *
+ * Parser records a journal of the changes it makes to the results
+ * (values, given options, and subcmds), and a boundary at the start
+ * of each argument. On next parse the journal is undone back to the
+ * last boundary before the first changed argument, and parsing
+ * resumes from there. Hence cost of parsing is proportional to the
+ * changed arguments (and the argument following the boundary), and
+ * the final checks (missing options, rules). Arguments are compared
+ * and copied to parse state, i.e. caller's argv may be released
+ * after the call.
+ *
+ * Errors are not reported, and program does not exit. Exit status,
+ * and error and usage output are returned in the parse result.
+ * Values are validated during parsing (not in parallel). Parse state
+ * allocates from heap. Only one incremental parse may be active.
+ *
+ *
+ * ## Zero-heap mode
+ *
+ * By default como allocates from a static buffer and continues from
+ * heap when it is exhausted. Alternatively all allocations (commands,
+ * options, values, argv, and usage text) can be made from a caller
+ * supplied buffer. Buffer is given before como_init(), and its size
+ * can be computed with como_required_mem():
+ * @code
+ *   static char mem[ 64 * 1024 ];
+ *
+ *   if ( como_required_mem( spec, size, argc ) > sizeof( mem ) ) {
+ *       ...
+ *   }
+ *   como_use_mem( mem, sizeof( mem ) );
+ *   como_command( ... );
+ * @endcode
+ *
+ * Running out of the buffer is a fatal error (no heap fallback).
+ * como_required_mem() gives an upper bound for one command. For
+ * subcommands, the command set is given to como_required_mem_cmds(),
+ * and the same table can be used for specification:
+ * @code
+ *   static const como_cmd_spec_s cmds[] = {
+ *       { "prog", NULL,   main_spec, COMO_SPEC_SIZE( main_spec ) },
+ *       { "run",  "prog", run_spec,  COMO_SPEC_SIZE( run_spec ) },
+ *   };
+ *
+ *   como_use_mem( mem, como_required_mem_cmds( cmds, 2, argc ) );
+ *   como_init( argc, argv, "Me", "2013" );
+ *   for ( int i = 0; i < 2; i++ ) {
+ *       como_spec_subcmd( cmds[ i ].name, cmds[ i ].parent, cmds[ i ].spec, cmds[ i ].size );
+ *   }
+ * @endcode
+ *
+ * Per argument memory (argv, argument classes, occurrences, and value
+ * arrays) is counted once for the set, and map tables of each command
+ * for all arguments. Bound assumes tab (see: como_conf_tab) of at most
+ * 64, and reserves 1 KiB per command for names, header, footer, and
+ * rules. como_used_mem() returns the actual usage.
+ *
+ * Parallel validation is not used in zero-heap mode. Export, import,
+ * server, and batch functions allocate from heap as before, and so
+ * does regex check compilation (regcomp). Enum check table build uses
+ * temporary heap memory, which is released before parsing.
+ *
+ *
+ * ## Building
+ *
+ * Como is available as a shared library (libcomo.so), a static
+ * library (libcomo.a), and as a single header (como_single.h). All are
+ * created by "sbin/do-build".
+ *
+ * Single header includes the implementation when COMO_IMPLEMENTATION
+ * is defined. The implementation must be included in one source file
+ * only. If also COMO_STATIC is defined, como is compiled with internal
+ * linkage into that source file, and can be inlined and optimized
+ * together with the user program:
+ * @code
+ *   #define COMO_STATIC
+ *   #define COMO_IMPLEMENTATION
+ *   #include <como_single.h>
+ * @endcode
+ *
+ * Static tracepoints (USDT) are compiled in when COMO_USDT is defined
+ * ("COMO_USDT=1 sbin/do-build"). Probes require "sys/sdt.h" (from
+ * SystemTap), and they are nops unless a tracer is attached. Without
+ * the header do-build fails, and other builds compile without probes
+ * (with a warning). do-build checks that the probes are in the
+ * object. Probes of provider "como":
+ * - parse__start( argc ): Parsing started.
+ * - parse__end( success ): Parsing (and checking) ended.
+ * - token( index, arg, class ): Argument classified as terminator (1),
+ *                               option (2), or positional (3).
+ * - lookup__hit( cmd, arg ): Option found for argument.
+ * - lookup__miss( cmd, arg ): No option for argument.
+ * - subcmd( longname ): Subcommand entered.
+ * - error( cmd, format ): Error reported.
+ * - usage( longname ): Usage rendered.
+ *
+ * For example:
+ * @code
+ *   bpftrace -e 'usdt:./prog:como:parse__start { @s[tid] = nsecs; }
+ *                usdt:./prog:como:parse__end { @ns = hist(nsecs - @s[tid]); }'
+ * @endcode
+ *
+ *
  * ## Customization
  *
  * If the default behavior is not satisfactory, changes can be
@@ -435,6 +899,8 @@
  * - #como_command( prog,author,year,... )
  * - #como_maincmd( prog,author,year,... )
  * - #como_subcmd( name,parentname,... )
+ * - void como_plugin( char* name, char* parentname, const char* path );
+ * - #como_plugin_define( handler,... )
  * - void como_finish( void );
  * - void como_end( void );
  *
@@ -449,7 +915,20 @@
  * - como_opt_t como_cmd_given( como_cmd_t cmd, char* name );
  * - como_cmd_t como_cmd_subcmd( como_cmd_t, char* name );
  * - como_cmd_t como_given_subcmd( void );
+ * - como_opt_t como_opt_at( como_handle_t handle );
+ * - char**     como_value_at( como_handle_t handle );
+ * - como_opt_t como_given_at( como_handle_t handle );
+ * - como_opt_t como_cmd_opt_at( como_cmd_t cmd, como_handle_t handle );
+ * - char**     como_cmd_value_at( como_cmd_t cmd, como_handle_t handle );
+ * - como_opt_t como_cmd_given_at( como_cmd_t cmd, como_handle_t handle );
+ * - pl_i64_t   como_resolve( como_cmd_t cmd, const char** names, como_handle_t* handles, pl_i64_t cnt );
  * - como_cmd_t como_cmd_given_subcmd( como_cmd_t parent );
+ * - const char* como_map_get( como_opt_t opt, const char* key );
+ * - como_map_t como_map( como_opt_t opt );
+ * - pl_i64_t   como_count( char* name );
+ * - pl_i64_t   como_cmd_count( como_cmd_t cmd, char* name );
+ * - void       como_iter_init( como_iter_t it, como_cmd_t cmd );
+ * - pl_bool_t  como_iter_next( como_iter_t it );
  *
  *
  * ### Configuration option setting functions
@@ -462,23 +941,112 @@
  * - void como_conf_check_invalid( pl_bool_t val );
  * - void como_conf_tab( pl_i32_t val );
  * - void como_conf_help_exit( pl_bool_t val );
+ * - void como_conf_threads( pl_i64_t val );
+ * - void como_conf_map_dup( pl_i64_t val );
+ * - void como_conf_validator( char* name, como_valid_fn_t fn, void* arg );
+ *
+ *
+ * ### Constraint functions
+ *
+ * - void como_rule_requires( char* name, ... );
+ * - void como_rule_conflicts( char* name, ... );
+ * - void como_rule_at_most_one( ... );
+ * - void como_rule_at_least_one( ... );
+ *
+ *
+ * ### Result binding functions
+ *
+ * - void como_bind( const char* name, pl_i64_t kind, void* target );
  *
  *
  * ### Generic functions
  *
  * - void como_error( const char* format, ... );
+ * - void como_fatal( const char* format, ... );
  * - void como_usage( void );
  * - void como_cmd_usage( como_cmd_t cmd );
  *
+ *
+ * ### Result transfer functions
+ *
+ * - pl_i64_t   como_export( void* buf, pl_i64_t size );
+ * - como_cmd_t como_import( const void* buf, pl_i64_t size );
+ * - void       como_import_end( como_cmd_t cmd );
+ * - como_cmd_t como_freeze( void );
+ * - int        como_spec_save( const char* file, const char* key );
+ * - int        como_spec_load( const char* file, const char* key );
+ *
+ *
+ * ### Server mode functions
+ *
+ * - void como_handler( como_handler_fn_t fn, void* arg );
+ * - int  como_serve( const char* path );
+ * - void como_serve_stop( void );
+ * - int  como_client( const char* path, int argc, char** argv );
+ *
+ *
+ * ### Batch mode functions
+ *
+ * - como_batch_t como_run_batch( const char* file, pl_i64_t threads );
+ * - void         como_batch_end( como_batch_t batch );
+ * - FILE*        como_out( void );
+ * - FILE*        como_err( void );
+ *
+ *
+ * ### Hot reload functions
+ *
+ * - int         como_watch( const char* file, como_change_fn_t fn, void* arg );
+ * - void        como_watch_stop( void );
+ * - como_snap_t como_snap_get( void );
+ * - void        como_snap_put( como_snap_t snap );
+ *
+ *
+ * ### Incremental parse functions
+ *
+ * - como_parse_t como_parse( como_parse_t prev, pl_i64_t argc, char** argv );
+ * - void         como_parse_end( como_parse_t parse );
+ *
+ *
+ * ### Memory functions
+ *
+ * - void     como_use_mem( void* buf, pl_i64_t size );
+ * - pl_i64_t como_used_mem( void );
+ * - pl_i64_t como_required_mem( const como_opt_spec_s* spec, pl_i64_t size, pl_i64_t argc );
+ * - pl_i64_t como_required_mem_cmds( const como_cmd_spec_s* cmds, pl_i64_t cnt, pl_i64_t argc );
+ *
  */
 
 
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <plinth.h>
 
 
+/*
+ * Symbol visibility. Library is built with hidden visibility and only
+ * the user interface is exported. In single-header mode (COMO_STATIC)
+ * all como symbols have internal linkage, which allows the compiler
+ * to inline and specialize como together with the caller.
+ */
+#if defined( COMO_STATIC )
+#define COMO_API static __attribute__( ( unused ) )
+#define COMO_EXTERN static
+#elif defined( __GNUC__ )
+#define COMO_API __attribute__( ( visibility( "default" ) ) )
+#define COMO_EXTERN extern __attribute__( ( visibility( "default" ) ) )
+#else
+#define COMO_API
+#define COMO_EXTERN extern
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
 /** Como-library version. */
-extern const char* como_version;
+COMO_EXTERN const char* como_version;
 
 
 /** Subcmd option. */
@@ -517,23 +1085,263 @@ extern const char* como_version;
 #define COMO_P_MUTEX ( 1 << 15 )
 /** Hidden option (no usage doc). */
 #define COMO_P_HIDDEN ( 1 << 16 )
+/** Key=value argument(s) in hash table. */
+#define COMO_P_MAP ( 1 << 17 )
+
+/** Optional key=value option (one or many). */
+#define COMO_MAP ( 1 << 18 )
+
+/** Repeatable switch, occurrences are counted. */
+#define COMO_P_COUNT ( 1 << 19 )
+
+/** Counted switch ("-v -v -v" is 3). */
+#define COMO_COUNT ( 1 << 20 )
+
+/** Duplicate map key: last value is used. */
+#define COMO_MAP_DUP_LAST 0
+/** Duplicate map key: first value is used. */
+#define COMO_MAP_DUP_FIRST 1
+/** Duplicate map key: error. */
+#define COMO_MAP_DUP_ERROR 2
 
 
 /** Option type. */
 typedef pl_u64_t como_opt_type_t;
 
 
+/**
+ * Option value validator function.
+ *
+ * @param value Option value.
+ * @param arg Validator argument.
+ *
+ * @return True if value is valid.
+ */
+typedef pl_bool_t ( *como_valid_fn_t )( const char* value, void* arg );
+
+
+/**
+ * Option value validator.
+ */
+pl_struct( como_valid )
+{
+    como_valid_fn_t fn;  /**< Validator function. */
+    void*           arg; /**< Validator argument. */
+};
+
+
+/** Enum check kind. */
+#define COMO_CHECK_KIND_ENUM 1
+/** Integer range check kind. */
+#define COMO_CHECK_KIND_RANGE 2
+/** Size check kind. */
+#define COMO_CHECK_KIND_SIZE 3
+/** Duration check kind. */
+#define COMO_CHECK_KIND_DURATION 4
+/** Regexp check kind. */
+#define COMO_CHECK_KIND_REGEX 5
+
+
+/**
+ * Declarative option value check.
+ */
+pl_struct( como_check )
+{
+    pl_i64_t     kind;    /**< Check kind. */
+    const char** set;     /**< Allowed values (NULL terminated). */
+    pl_i64_t     min;     /**< Minimum value. */
+    pl_i64_t     max;     /**< Maximum value. */
+    const char*  pattern; /**< Regexp pattern. */
+};
+
+
+/** Value is one of the listed strings. */
+#define COMO_CHECK_ENUM( ... )                                                                 \
+    ( &(const como_check_s){                                                                   \
+        COMO_CHECK_KIND_ENUM, (const char*[]){ __VA_ARGS__, NULL }, 0, 0, NULL } )
+
+/** Integer value within range. */
+#define COMO_CHECK_RANGE( min, max ) \
+    ( &(const como_check_s){ COMO_CHECK_KIND_RANGE, NULL, ( min ), ( max ), NULL } )
+
+/** Size value (with suffix) within range (bytes). */
+#define COMO_CHECK_SIZE( min, max ) \
+    ( &(const como_check_s){ COMO_CHECK_KIND_SIZE, NULL, ( min ), ( max ), NULL } )
+
+/** Duration value (with suffix) within range (milliseconds). */
+#define COMO_CHECK_DURATION( min, max ) \
+    ( &(const como_check_s){ COMO_CHECK_KIND_DURATION, NULL, ( min ), ( max ), NULL } )
+
+/** Value matches regexp. */
+#define COMO_CHECK_REGEX( pattern ) \
+    ( &(const como_check_s){ COMO_CHECK_KIND_REGEX, NULL, 0, 0, ( pattern ) } )
+
+
 /**
  * Option specification entry.
  */
 pl_struct( como_opt_spec )
 {
-    como_opt_type_t type; /**< Option type. */
-    const char*     name; /**< Option name (for reference). */
-    const char*     opt;  /**< Short switch ("-x" or NULL). Longopt is used if NULL. */
-    const char*     doc;  /**< Option documentation. */
+    como_opt_type_t     type;  /**< Option type. */
+    const char*         name;  /**< Option name (for reference). */
+    const char*         opt;   /**< Short switch ("-x" or NULL). Longopt is used if NULL. */
+    const char*         doc;     /**< Option documentation. */
+    const como_check_s* check;   /**< Value check (or NULL). */
+    const char*         longopt; /**< Longopt ("--name") or NULL for generated. */
+};
+
+
+/**
+ * Option specification entry with compile time longopt. Name is given
+ * as identifier.
+ */
+#define COMO_OPT( type, name, opt, doc ) \
+    { ( type ), #name, ( opt ), ( doc ), NULL, "--" #name }
+
+
+/**
+ * Command specification entry (see: como_required_mem_cmds()).
+ */
+pl_struct( como_cmd_spec )
+{
+    char*                  name;   /**< Command name. */
+    char*                  parent; /**< Parent command name (NULL for main). */
+    const como_opt_spec_s* spec;   /**< Option specifications. */
+    pl_i64_t               size;   /**< Specification count. */
+};
+
+/** Specification count of option specification array. */
+#define COMO_SPEC_SIZE( spec ) ( (pl_i64_t)( sizeof( spec ) / sizeof( como_opt_spec_s ) ) )
+
+
+/** Boolean result field kind (_Bool). */
+#define COMO_BIND_BOOL 1
+/** Integer result field kind (int). */
+#define COMO_BIND_INT 2
+/** 64-bit integer result field kind (int64_t). */
+#define COMO_BIND_I64 3
+/** Floating point result field kind (double). */
+#define COMO_BIND_DOUBLE 4
+/** String result field kind (char*). */
+#define COMO_BIND_STRING 5
+/** String list result field kind (char**). */
+#define COMO_BIND_LIST 6
+
+/** Result field kind from field type. */
+#define COMO_BIND_KIND( field )                  \
+    _Generic( ( field ),                         \
+              _Bool: COMO_BIND_BOOL,             \
+              int: COMO_BIND_INT,                \
+              int64_t: COMO_BIND_I64,            \
+              double: COMO_BIND_DOUBLE,          \
+              const char*: COMO_BIND_STRING,     \
+              char*: COMO_BIND_STRING,           \
+              char**: COMO_BIND_LIST )
+
+/** Specification entry from option list entry. */
+#define COMO_X_SPEC( type, ctype, name, opt, doc ) COMO_OPT( type, name, opt, doc ),
+
+/** Result struct field from option list entry. */
+#define COMO_X_FIELD( type, ctype, name, opt, doc ) ctype name;
+
+/** Handle field (offset is handle) from option list entry. */
+#define COMO_X_HANDLE( type, ctype, name, opt, doc ) char name;
+
+/** Result field binding from option list entry (for "res" struct). */
+#define COMO_X_BIND( type, ctype, name, opt, doc ) \
+    como_bind( ( type ) == COMO_DEFAULT ? NULL : #name, COMO_BIND_KIND( res->name ), &res->name );
+
+/**
+ * Generate result struct (<name>_s), specification table
+ * (<name>_spec), binding function (<name>_bind), and handles (see:
+ * COMO_HANDLE) from option list X-macro.
+ *
+ * @code
+ *   #define PROG_OPTS( X )                                       \
+ *       X( COMO_OPT_SINGLE, int64_t,     threads, "-t", "Threads." ) \
+ *       X( COMO_OPT_SINGLE, const char*, file,    "-f", "File." )    \
+ *       X( COMO_SWITCH,     _Bool,       debug,   "-d", "Debug." )
+ *
+ *   COMO_STRUCT( prog_opts, PROG_OPTS )
+ * @endcode
+ */
+#define COMO_STRUCT( name, list )                                         \
+    typedef struct {                                                      \
+        list( COMO_X_FIELD )                                              \
+    } name##_s;                                                           \
+    typedef struct {                                                      \
+        list( COMO_X_HANDLE )                                             \
+    } name##_handles_s;                                                   \
+    static const como_opt_spec_s name##_spec[] = { list( COMO_X_SPEC ) }; \
+    static inline void name##_bind( name##_s* res ) { list( COMO_X_BIND ) }
+
+/**
+ * Handle of option in option list X-macro (see: COMO_STRUCT), i.e.
+ * specification index as compile time constant.
+ *
+ * @code
+ *   if ( como_given_at( COMO_HANDLE( prog_opts, debug ) ) ) ...
+ * @endcode
+ */
+#define COMO_HANDLE( name, field ) ( (como_handle_t)offsetof( name##_handles_s, field ) )
+
+/**
+ * Option specification entry with compile time longopt and value
+ * check.
+ */
+#define COMO_OPT_CHECK( type, name, opt, doc, check ) \
+    { ( type ), #name, ( opt ), ( doc ), ( check ), "--" #name }
+
+
+
+/**
+ * Map option entry. Key and value refer to the "key=value" argument,
+ * i.e. key is not null terminated.
+ */
+pl_struct( como_map_entry )
+{
+    const char* key;    /**< Key (or NULL for empty slot). */
+    pl_i64_t    keylen; /**< Key length. */
+    const char* value;  /**< Value (after "="). */
+};
+
+
+/**
+ * Map option hash table (open addressing, linear probing).
+ */
+pl_struct( como_map )
+{
+    pl_i64_t          cnt;   /**< Number of keys. */
+    pl_u64_t          mask;  /**< Table size minus one. */
+    como_map_entry_s* slots; /**< Table. */
+};
+
+
+/**
+ * Option occurrence on command line.
+ */
+pl_struct( como_occur )
+{
+    pl_u32_t idx;      /**< Argument index (in como_argv). */
+    pl_u32_t opt;      /**< Option index (in command options). */
+    pl_u32_t value;    /**< Index of first value (in option values). */
+    pl_u32_t valuecnt; /**< Number of values. */
 };
 
+typedef como_occur_t* como_occur_p;
+
+
+/**
+ * Option fields that most options don't use (side table entry). Entry
+ * is created for options with validator, map, or bound result field.
+ */
+pl_struct( como_opt_ext )
+{
+    como_valid_t valid;  /**< Value validator (or NULL). */
+    como_map_t   map;    /**< Map of "key=value" values (or NULL). */
+    pl_i64_t     bind;   /**< Bound result field kind. */
+    void*        target; /**< Bound result field address (or NULL). */
+};
 
 
 /**
@@ -562,8 +1370,18 @@ pl_struct( como_opt )
     char**   value;
     pl_i64_t valuecnt;
 
+    /** Lengths of given option values (or NULL if no values). */
+    pl_size_t* valuelen;
+
     /** True if option was set on CLI. */
     pl_bool_t given;
+
+    /** Occurrences in command line order (or NULL if not given). */
+    como_occur_t occur;
+    pl_i64_t     occurcnt;
+
+    /** Validator, map, and bound field (or NULL if none). */
+    como_opt_ext_t ext; /* Only for internal use. */
 };
 
 
@@ -621,25 +1439,192 @@ pl_struct( como_config )
      * default: true
      */
     pl_bool_t help_exit;
+
+    /**
+     * Number of threads for option value validation.
+     * default: 1
+     */
+    pl_i64_t threads;
+
+    /**
+     * Duplicate key policy for map options.
+     * default: COMO_MAP_DUP_LAST
+     */
+    pl_i64_t map_dup;
+
+    /** Number of commands sharing config. */
+    pl_i64_t refcnt; /* Only for internal use. */
 };
 
-pl_struct_type( como_cmd );
 
 /**
- * Program level option information including program information and
- * parsing results.
+ * Option lookup keys of command in structure-of-arrays layout. Only
+ * for internal use.
  */
-pl_struct_body( como_cmd )
+pl_struct( como_keys )
 {
+    pl_u32_t*    type;     /**< Option type primitives. */
+    pl_u32_t*    longlen;  /**< Option name (longopt) length. */
+    pl_u64_t*    prefix;   /**< Option name start (8 chars). */
+    const char** name;     /**< Option name. */
+    const char** shortopt; /**< Short switch (or NULL). */
+};
 
-    /** Command name. */
-    char* name;
+/** Requires rule kind. */
+#define COMO_RULE_KIND_REQUIRES 1
+/** Conflicts rule kind. */
+#define COMO_RULE_KIND_CONFLICTS 2
+/** At most one rule kind. */
+#define COMO_RULE_KIND_AT_MOST_ONE 3
+/** At least one rule kind. */
+#define COMO_RULE_KIND_AT_LEAST_ONE 4
 
-    /** Name with hierachy. */
-    char* longname;
+/** First option requires all the other options. */
+#define como_rule_requires( name, ... ) \
+    como_rule( COMO_RULE_KIND_REQUIRES, (const char*[]){ ( name ), __VA_ARGS__, NULL } )
 
-    /** Program author. */
-    char* author;
+/** First option conflicts with all the other options. */
+#define como_rule_conflicts( name, ... ) \
+    como_rule( COMO_RULE_KIND_CONFLICTS, (const char*[]){ ( name ), __VA_ARGS__, NULL } )
+
+/** At most one of the options. */
+#define como_rule_at_most_one( ... ) \
+    como_rule( COMO_RULE_KIND_AT_MOST_ONE, (const char*[]){ __VA_ARGS__, NULL } )
+
+/** At least one of the options. */
+#define como_rule_at_least_one( ... ) \
+    como_rule( COMO_RULE_KIND_AT_LEAST_ONE, (const char*[]){ __VA_ARGS__, NULL } )
+
+
+/**
+ * Option handle, i.e. option index in command specification.
+ */
+typedef pl_i64_t como_handle_t;
+
+/** Handle of automatic help option. */
+#define COMO_HELP_HANDLE ( -1 )
+/** Unresolved handle. */
+#define COMO_NO_HANDLE ( -2 )
+
+
+pl_struct_type( como_rule );
+
+/**
+ * Option constraint compiled to option bitmask. Only for internal use.
+ */
+pl_struct_body( como_rule )
+{
+    pl_i64_t    kind;  /**< Rule kind. */
+    pl_i64_t    first; /**< First option index (REQUIRES, CONFLICTS). */
+    pl_u64_t*   mask;  /**< Option bitmask (other options). */
+    como_rule_t next;  /**< Next rule. */
+};
+
+
+/** Name suggestion index (BK-tree node). Only for internal use. */
+pl_struct_type( como_bknode );
+
+
+pl_struct_type( como_cmd );
+
+/**
+ * Command handler for server mode.
+ *
+ * @param cmd Given command.
+ * @param arg Handler argument.
+ *
+ * @return Exit status for client.
+ */
+typedef int ( *como_handler_fn_t )( como_cmd_t cmd, void* arg );
+
+
+/** Plugin symbol (see: como_plugin_define()). */
+#define COMO_PLUGIN_SYMBOL "como_plugin_entry"
+
+/**
+ * Plugin subcommand specification and handler.
+ */
+pl_struct( como_plugin )
+{
+    const como_opt_spec_s* spec;        /**< Option specification. */
+    pl_i64_t               size;        /**< Specification size. */
+    como_handler_fn_t      handler;     /**< Handler (or NULL). */
+    void*                  handler_arg; /**< Handler argument. */
+};
+
+
+/**
+ * Option occurrence iterator (see: como_iter_init()).
+ */
+pl_struct( como_iter )
+{
+    como_cmd_t   cmd;   /**< Command. */
+    pl_i64_t     pos;   /**< Position of next occurrence. */
+    como_opt_t   opt;   /**< Option of current occurrence. */
+    como_occur_t occur; /**< Current occurrence. */
+};
+
+
+/**
+ * Batch results in input order.
+ */
+pl_struct( como_batch )
+{
+    pl_i64_t cnt;    /**< Number of command lines. */
+    char**   output; /**< Output (and errors) of each command line. */
+    int*     status; /**< Exit status of each command line. */
+};
+
+
+/**
+ * Parse results snapshot (hot reload). Results are read-only and
+ * remain valid until the snapshot is released.
+ */
+pl_struct( como_snap )
+{
+    como_cmd_t cmd;    /**< Main command. */
+    pl_i64_t   refcnt; /* Only for internal use. */
+    void*      buf;    /* Only for internal use. */
+};
+
+
+/**
+ * Incremental parse result (see: como_parse()). Parse results are in
+ * the global results (como_opt() etc.).
+ */
+pl_struct( como_parse )
+{
+    int         status; /**< Exit status (0 if parsed successfully). */
+    const char* msg;    /**< Errors and usage (empty if none). */
+    pl_i64_t    reused; /**< Number of arguments not parsed again. */
+};
+
+
+/**
+ * Option change callback for hot reload.
+ *
+ * @param cmd Command of option (in new results).
+ * @param old Option in previous results (or NULL).
+ * @param opt Option in new results (or NULL).
+ * @param arg Callback argument.
+ */
+typedef void ( *como_change_fn_t )( como_cmd_t cmd, como_opt_t old, como_opt_t opt, void* arg );
+
+/**
+ * Program level option information including program information and
+ * parsing results.
+ */
+pl_struct_body( como_cmd )
+{
+
+    /** Command name. */
+    char* name;
+
+    /** Name with hierachy. */
+    char* longname;
+
+    /** Program author. */
+    char* author;
 
     /** Year (or data for program). */
     char* year;
@@ -650,6 +1635,20 @@ pl_struct_body( como_cmd )
     /** Array of options (objects). */
     como_opt_p opts;
 
+    /** Option lookup keys. */
+    como_keys_t keys; /* Only for internal use. */
+
+    /** Option specification (options are created on first use). */
+    const como_opt_spec_s* spec;     /* Only for internal use. */
+    pl_i64_t               specsize; /* Only for internal use. */
+
+    /** Option specification in spec cache (when spec is NULL). */
+    const void* image; /* Only for internal use. */
+
+    /** Plugin path (until loaded) and handle. */
+    char* plugin;        /* Only for internal use. */
+    void* plugin_handle; /* Only for internal use. */
+
     /** Parent (host) for this subcmd. */
     como_cmd_t parent;
 
@@ -665,27 +1664,45 @@ pl_struct_body( como_cmd )
     /** Number of given arguments. */
     pl_i64_t givencnt;
 
+    /** Option occurrences in command line order. */
+    como_occur_p order;
+    pl_i64_t     ordercnt;
+
     /** Number of option errors. */
     pl_i64_t errors;
 
     /** Command configuration. */
     como_config_t conf;
+
+    /** Option bitsets: given, required, and exclusive. */
+    pl_u64_t* bits;     /* Only for internal use. */
+    pl_i64_t  bitwords; /* Only for internal use. */
+
+    /** Option constraints. */
+    como_rule_t rules; /* Only for internal use. */
+
+    /** Name suggestion index (created on first unknown name). */
+    como_bknode_t suggest; /* Only for internal use. */
+
+    /** Server mode handler and its argument (or NULL). */
+    como_handler_fn_t handler;
+    void*             handler_arg;
 };
 
 
 /** Active como command (under processing). Same as main after option
     parsing. */
-extern como_cmd_t como_cmd;
+COMO_EXTERN como_cmd_t como_cmd;
 
 /** Main command, i.e. root of command hierarchy. */
-extern como_cmd_t como_main;
+COMO_EXTERN como_cmd_t como_main;
 
 
 /** Number of arguments for como. */
-extern pl_i64_t como_argc;
+COMO_EXTERN pl_i64_t como_argc;
 
 /** Array of arguments for como. */
-extern char** como_argv;
+COMO_EXTERN char** como_argv;
 
 
 
@@ -718,24 +1735,61 @@ extern char** como_argv;
  * User interface (macro) for main cmd (program) specification.
  */
 #define como_maincmd( prog, author, year, ... ) \
-    do {                                        \
-        como_init( argc, argv, author, year );  \
-        como_subcmd( prog, NULL, __VA_ARGS__ ); \
-    } while ( 0 )
+    ( como_init( argc, argv, author, year ), como_subcmd( prog, NULL, __VA_ARGS__ ) )
+
+
+/**
+ * User interface (macro) for sub-command specification. Specification
+ * array is copied, hence macro can be used in any function.
+ */
+#define como_subcmd( name, parentname, ... )                           \
+    como_spec_subcmd_copy( name,                                       \
+                           parentname,                                 \
+                           (const como_opt_spec_s[]){ __VA_ARGS__ },   \
+                           como_spec_size( __VA_ARGS__ ) )
 
+/**
+ * User interface (macro) for sub-command specification with static
+ * specification table. Table is used in place, i.e. it is not copied.
+ *
+ * Example:
+ * @code
+ *   static const como_opt_spec_s add_spec[] = {
+ *       COMO_OPT( COMO_SWITCH, force, "-fo", "Force operation." ),
+ *       COMO_OPT( COMO_SINGLE, file, "-f", "File." ),
+ *   };
+ *
+ *   como_subcmd_table( "add", "como_subcmd", add_spec );
+ * @endcode
+ */
+#define como_subcmd_table( name, parentname, table ) \
+    como_spec_subcmd( name, parentname, table, sizeof( table ) / sizeof( como_opt_spec_s ) )
 
 /**
- * User interface (macro) for sub-command specification.
+ * Plugin subcommand definition (in plugin shared object). Options are
+ * given as with como_subcmd(). Host program must export como symbols
+ * (see: Plugin subcommands).
+ *
+ * Example:
+ * @code
+ *   como_plugin_define( db_handler,
+ *                       { COMO_SWITCH, "vacuum", "-v", "Vacuum." },
+ *                       { COMO_SINGLE, "file",   "-f", "Database." } );
+ * @endcode
  */
-#define como_subcmd( name, parentname, ... ) \
-    como_spec_subcmd(                        \
-        name, parentname, (como_opt_spec_s[]){ __VA_ARGS__ }, como_spec_size( __VA_ARGS__ ) )
+#define como_plugin_define( handler, ... )                             \
+    COMO_API const como_plugin_s como_plugin_entry = {                 \
+        (const como_opt_spec_s[]){ __VA_ARGS__ },                      \
+        como_spec_size( __VA_ARGS__ ),                                 \
+        ( handler ),                                                   \
+        NULL                                                           \
+    }
 
 /**
  * Option specification list (array) size.
  */
 #define como_spec_size( ... ) \
-    ( sizeof( (como_opt_spec_s[]){ __VA_ARGS__ } ) / sizeof( como_opt_spec_s ) )
+    ( sizeof( (const como_opt_spec_s[]){ __VA_ARGS__ } ) / sizeof( como_opt_spec_s ) )
 
 
 
@@ -746,7 +1800,7 @@ extern char** como_argv;
 /**
  * Finalize setup and parse all options.
  */
-void como_finish( void );
+COMO_API void como_finish( void );
 
 
 
@@ -762,7 +1816,7 @@ void como_finish( void );
  *
  * @return Option.
  */
-como_opt_t como_opt( char* name );
+COMO_API como_opt_t como_opt( char* name );
 
 /**
  * Get value of main command option.
@@ -771,7 +1825,7 @@ como_opt_t como_opt( char* name );
  *
  * @return Option value.
  */
-char** como_value( char* name );
+COMO_API char** como_value( char* name );
 
 /**
  * Get given status of main command option.
@@ -780,7 +1834,7 @@ char** como_value( char* name );
  *
  * @return Option if given.
  */
-como_opt_t como_given( char* name );
+COMO_API como_opt_t como_given( char* name );
 
 /**
  * Get command option (by name).
@@ -790,7 +1844,7 @@ como_opt_t como_given( char* name );
  *
  * @return Option.
  */
-como_opt_t como_cmd_opt( como_cmd_t cmd, char* name );
+COMO_API como_opt_t como_cmd_opt( como_cmd_t cmd, char* name );
 
 /**
  * Get value of command option.
@@ -800,7 +1854,7 @@ como_opt_t como_cmd_opt( como_cmd_t cmd, char* name );
  *
  * @return Option value.
  */
-char** como_cmd_value( como_cmd_t cmd, char* name );
+COMO_API char** como_cmd_value( como_cmd_t cmd, char* name );
 
 /**
  * Get given status of command option.
@@ -810,7 +1864,76 @@ char** como_cmd_value( como_cmd_t cmd, char* name );
  *
  * @return Option's given status (true if given).
  */
-como_opt_t como_cmd_given( como_cmd_t cmd, char* name );
+COMO_API como_opt_t como_cmd_given( como_cmd_t cmd, char* name );
+
+/**
+ * Get main command option (by handle).
+ *
+ * @param handle Option handle.
+ *
+ * @return Option (or NULL if handle is out of range).
+ */
+COMO_API como_opt_t como_opt_at( como_handle_t handle );
+
+/**
+ * Get value of main command option (by handle).
+ *
+ * @param handle Option handle.
+ *
+ * @return Option value (or NULL if handle is out of range).
+ */
+COMO_API char** como_value_at( como_handle_t handle );
+
+/**
+ * Get given status of main command option (by handle).
+ *
+ * @param handle Option handle.
+ *
+ * @return Option if given (NULL if not, or out of range).
+ */
+COMO_API como_opt_t como_given_at( como_handle_t handle );
+
+/**
+ * Get command option (by handle).
+ *
+ * @param cmd Command containing option.
+ * @param handle Option handle.
+ *
+ * @return Option (or NULL if handle is out of range).
+ */
+COMO_API como_opt_t como_cmd_opt_at( como_cmd_t cmd, como_handle_t handle );
+
+/**
+ * Get value of command option (by handle).
+ *
+ * @param cmd Command containing option.
+ * @param handle Option handle.
+ *
+ * @return Option value (or NULL if handle is out of range).
+ */
+COMO_API char** como_cmd_value_at( como_cmd_t cmd, como_handle_t handle );
+
+/**
+ * Get given status of command option (by handle).
+ *
+ * @param cmd Command containing option.
+ * @param handle Option handle.
+ *
+ * @return Option if given (NULL if not, or out of range).
+ */
+COMO_API como_opt_t como_cmd_given_at( como_cmd_t cmd, como_handle_t handle );
+
+/**
+ * Resolve option handles for option names.
+ *
+ * @param cmd Command containing options.
+ * @param names Option names (NULL for default arg).
+ * @param handles Resolved handles (COMO_NO_HANDLE if not found).
+ * @param cnt Number of names.
+ *
+ * @return Number of resolved names.
+ */
+COMO_API pl_i64_t como_resolve( como_cmd_t cmd, const char** names, como_handle_t* handles, pl_i64_t cnt );
 
 /**
  * Get cmd's sub-command (by name).
@@ -820,14 +1943,14 @@ como_opt_t como_cmd_given( como_cmd_t cmd, char* name );
  *
  * @return Subcmd.
  */
-como_cmd_t como_cmd_subcmd( como_cmd_t cmd, char* name );
+COMO_API como_cmd_t como_cmd_subcmd( como_cmd_t cmd, char* name );
 
 /**
  * Return given subcmd for como_main.
  *
  * @return Subcmd (or NULL).
  */
-como_cmd_t como_given_subcmd( void );
+COMO_API como_cmd_t como_given_subcmd( void );
 
 /**
  * Return given subcmd for parent.
@@ -836,14 +1959,71 @@ como_cmd_t como_given_subcmd( void );
  *
  * @return Subcmd (or NULL).
  */
-como_cmd_t como_cmd_given_subcmd( como_cmd_t parent );
+COMO_API como_cmd_t como_cmd_given_subcmd( como_cmd_t parent );
+
+/**
+ * Get value of key from map option ("key=value" arguments).
+ *
+ * @param opt Map option.
+ * @param key Key.
+ *
+ * @return Value (or NULL if key is not given).
+ */
+COMO_API const char* como_map_get( como_opt_t opt, const char* key );
+
+/**
+ * Get hash table of map option.
+ *
+ * @param opt Map option.
+ *
+ * @return Map (or NULL if option is not given).
+ */
+COMO_API como_map_t como_map( como_opt_t opt );
+
+/**
+ * Get number of occurrences of main command option (e.g. count of
+ * COMO_COUNT switch).
+ *
+ * @param name Option name.
+ *
+ * @return Count (0 if not given).
+ */
+COMO_API pl_i64_t como_count( char* name );
+
+/**
+ * Get number of occurrences of command option.
+ *
+ * @param cmd Command containing option.
+ * @param name Option name.
+ *
+ * @return Count (0 if not given).
+ */
+COMO_API pl_i64_t como_cmd_count( como_cmd_t cmd, char* name );
+
+/**
+ * Initialize iterator over option occurrences of command in command
+ * line order.
+ *
+ * @param it Iterator.
+ * @param cmd Command.
+ */
+COMO_API void como_iter_init( como_iter_t it, como_cmd_t cmd );
+
+/**
+ * Advance iterator to next occurrence (see: como_iter_init()).
+ *
+ * @param it Iterator.
+ *
+ * @return True if occurrence is available (it->opt and it->occur).
+ */
+COMO_API pl_bool_t como_iter_next( como_iter_t it );
 
 /**
  * Return program external argument list.
  *
  * @return External args.
  */
-char** como_external( void );
+COMO_API char** como_external( void );
 
 /**
  * Generate id for option. Use short option if defined, otherwise
@@ -853,7 +2033,7 @@ char** como_external( void );
  *
  * @return Id.
  */
-const char* como_opt_id( como_opt_t opt );
+COMO_API const char* como_opt_id( como_opt_t opt );
 
 
 
@@ -863,28 +2043,77 @@ const char* como_opt_id( como_opt_t opt );
 
 
 /** Set autohelp configuration value. */
-void como_conf_autohelp( pl_bool_t val );
+COMO_API void como_conf_autohelp( pl_bool_t val );
 
 /** Set header configuration value. */
-void como_conf_header( char* val );
+COMO_API void como_conf_header( char* val );
 
 /** Set footer configuration value. */
-void como_conf_footer( char* val );
+COMO_API void como_conf_footer( char* val );
 
 /** Set subcheck configuration value. */
-void como_conf_subcheck( pl_bool_t val );
+COMO_API void como_conf_subcheck( pl_bool_t val );
 
 /** Set check_missing configuration value. */
-void como_conf_check_missing( pl_bool_t val );
+COMO_API void como_conf_check_missing( pl_bool_t val );
 
 /** Set check_invalid configuration value. */
-void como_conf_check_invalid( pl_bool_t val );
+COMO_API void como_conf_check_invalid( pl_bool_t val );
 
 /** Set tab configuration value. */
-void como_conf_tab( pl_i64_t val );
+COMO_API void como_conf_tab( pl_i64_t val );
 
 /** Set help_exit configuration value. */
-void como_conf_help_exit( pl_bool_t val );
+COMO_API void como_conf_help_exit( pl_bool_t val );
+
+/** Set threads configuration value. */
+COMO_API void como_conf_threads( pl_i64_t val );
+
+/** Set map_dup configuration value. */
+COMO_API void como_conf_map_dup( pl_i64_t val );
+
+/**
+ * Set validator for option.
+ *
+ * @param name Option name (NULL for default arg).
+ * @param fn Validator function.
+ * @param arg Argument for validator function.
+ */
+COMO_API void como_conf_validator( char* name, como_valid_fn_t fn, void* arg );
+
+/**
+ * Add option constraint. Use the rule macros (como_rule_requires()
+ * etc.) instead of calling this directly.
+ *
+ * @param kind Rule kind (COMO_RULE_KIND_*).
+ * @param names NULL terminated array of option names.
+ */
+COMO_API void como_rule( pl_i64_t kind, const char** names );
+
+/**
+ * Bind option to result field. Field is updated during parsing, and
+ * values are converted to field type. Use COMO_STRUCT instead of
+ * calling this directly.
+ *
+ * @param name Option name (NULL for default arg).
+ * @param kind Field kind (COMO_BIND_*).
+ * @param target Field address.
+ */
+COMO_API void como_bind( const char* name, pl_i64_t kind, void* target );
+
+
+/*
+ * Predefined validators:
+ */
+
+/** Validate integer value. */
+COMO_API pl_bool_t como_valid_integer( const char* value, void* arg );
+
+/** Validate existing path. Arg is NULL or pointer to access() mode. */
+COMO_API pl_bool_t como_valid_path( const char* value, void* arg );
+
+/** Validate value with regexp. Arg is a compiled regex_t pointer. */
+COMO_API pl_bool_t como_valid_regex( const char* value, void* arg );
 
 
 /*
@@ -897,20 +2126,28 @@ void como_conf_help_exit( pl_bool_t val );
  * @param format String formatter.
  * @param ... Args for formatter.
  */
-void como_error( const char* format, ... );
+COMO_API void como_error( const char* format, ... );
+
+/**
+ * Report fatal (internal) error to stderr, with "COMO FATAL: " prefix.
+ *
+ * @param format String formatter.
+ * @param ... Args for formatter.
+ */
+COMO_API void como_fatal( const char* format, ... );
 
 /**
  * Display main command usage.
  *
  */
-void como_usage( void );
+COMO_API void como_usage( void );
 
 /**
  * Display command usage.
  *
  * @param cmd Command to display.
  */
-void como_cmd_usage( como_cmd_t cmd );
+COMO_API void como_cmd_usage( como_cmd_t cmd );
 
 /**
  * Display options's value(s). Used for testing/debug.
@@ -918,7 +2155,301 @@ void como_cmd_usage( como_cmd_t cmd );
  * @param fh File stream to use.
  * @param o Option to display.
  */
-void como_display_values( FILE* fh, como_opt_t o );
+COMO_API void como_display_values( FILE* fh, como_opt_t o );
+
+
+/*
+ * Result transfer functions.
+ */
+
+/**
+ * Export parse results (commands, options, values, and external args)
+ * to a position independent buffer. Buffer can be passed to other
+ * processes (e.g. through file, pipe, or shared memory) and imported
+ * with como_import().
+ *
+ * Buffer is written only if it is large enough. Call with NULL buffer
+ * to query the required size.
+ *
+ * @param buf Buffer (or NULL).
+ * @param size Buffer size.
+ *
+ * @return Required buffer size.
+ */
+COMO_API pl_i64_t como_export( void* buf, pl_i64_t size );
+
+/**
+ * Import parse results from buffer created by como_export(). The
+ * command and option views are created in one allocation, and strings
+ * are referenced from the buffer. Buffer is not modified (it can be a
+ * read-only mapping), but it must remain valid while the results are
+ * used. Indices and string offsets are validated against the buffer
+ * before import.
+ *
+ * Imported main command is set to como_main and como_cmd.
+ *
+ * @param buf Buffer.
+ * @param size Buffer size.
+ *
+ * @return Main command (or NULL if buffer is invalid).
+ */
+COMO_API como_cmd_t como_import( const void* buf, pl_i64_t size );
+
+/**
+ * Release results created by como_import().
+ *
+ * @param cmd Imported main command.
+ */
+COMO_API void como_import_end( como_cmd_t cmd );
+
+/**
+ * Freeze parse results: copy commands, options, values, and external
+ * args to one compact page aligned block, and release all other como
+ * memory. Called after como_finish().
+ *
+ * Results are accessed as before. Options and values are read-only,
+ * but commands and configuration are not (error reporting, usage, and
+ * configuration). No parsing (or specification) is possible. Block is
+ * released by como_end(). Does nothing in zero-heap mode.
+ *
+ * @return Main command (or NULL if memory is not available).
+ */
+COMO_API como_cmd_t como_freeze( void );
+
+/**
+ * Save command specification (commands, options, and configuration)
+ * to spec cache file. File is written to temporary file first, and
+ * then renamed, hence concurrent loaders see either old or new file.
+ * Called after specification and before parsing.
+ *
+ * @param file Cache file.
+ * @param key Specification key (or NULL), see: como_spec_load().
+ *
+ * @return 0 on success, -1 on error.
+ */
+COMO_API int como_spec_save( const char* file, const char* key );
+
+/**
+ * Load command specification from spec cache file created by
+ * como_spec_save(). Used instead of como_spec_subcmd() calls after
+ * como_init(). File is mapped read-only, and strings are used directly
+ * from the mapping. Options are created from the mapping when command
+ * is used.
+ *
+ * File is not loaded if it is invalid, or if it was saved with other
+ * key (i.e. it is stale).
+ *
+ * Mapping is released by como_end().
+ *
+ * @param file Cache file.
+ * @param key Specification key (or NULL) given to como_spec_save().
+ *
+ * @return 0 on success, -1 if file is missing, invalid, or stale.
+ */
+COMO_API int como_spec_load( const char* file, const char* key );
+
+
+/*
+ * Server mode functions.
+ */
+
+/**
+ * Set server mode handler for the most recently specified command.
+ *
+ * @param fn Handler function.
+ * @param arg Handler argument.
+ */
+COMO_API void como_handler( como_handler_fn_t fn, void* arg );
+
+/**
+ * Serve client requests from Unix socket. Each request is parsed with
+ * the specified command tree and dispatched to the handler of the
+ * given command (or its closest ancestor with handler).
+ *
+ * Use instead of como_finish().
+ *
+ * @param path Socket path.
+ *
+ * @return 0 if stopped by como_serve_stop(), -1 on socket error.
+ */
+COMO_API int como_serve( const char* path );
+
+/**
+ * Stop server after the current request.
+ */
+COMO_API void como_serve_stop( void );
+
+/**
+ * Forward command line (with stdio, cwd, and environment) to server.
+ *
+ * @param path Socket path.
+ * @param argc Argument count.
+ * @param argv Arguments.
+ *
+ * @return Exit status from server (-1 if server is not available).
+ */
+COMO_API int como_client( const char* path, int argc, char** argv );
+
+
+/*
+ * Batch mode functions.
+ */
+
+/**
+ * Run command lines from file, one command line per line. Lines are
+ * parsed with the specified command tree, and the handlers of the
+ * given commands are run by a worker pool.
+ *
+ * Use instead of como_finish().
+ *
+ * @param file Command file.
+ * @param threads Number of worker threads.
+ *
+ * @return Batch results (or NULL if file can not be read, or out of
+ *         memory).
+ */
+COMO_API como_batch_t como_run_batch( const char* file, pl_i64_t threads );
+
+/**
+ * Release batch results.
+ *
+ * @param batch Batch results.
+ */
+COMO_API void como_batch_end( como_batch_t batch );
+
+/**
+ * Output stream for handlers and usage: stdout, or command line
+ * specific stream in batch mode.
+ *
+ * @return Output stream.
+ */
+COMO_API FILE* como_out( void );
+
+/**
+ * Error stream: stderr, or command line specific stream in batch mode.
+ *
+ * @return Error stream.
+ */
+COMO_API FILE* como_err( void );
+
+
+/*
+ * Hot reload functions.
+ */
+
+/**
+ * Watch file with additional arguments, and publish parse results as
+ * snapshots. Called after como_finish(). Only one file is watched at
+ * a time (see: como_watch_stop()).
+ *
+ * @param file File with arguments.
+ * @param fn Option change callback (or NULL).
+ * @param arg Callback argument.
+ *
+ * @return 0 on success (-1 if file directory can't be watched, if
+ *         already watching, or in zero-heap mode or after
+ *         como_freeze()).
+ */
+COMO_API int como_watch( const char* file, como_change_fn_t fn, void* arg );
+
+/**
+ * Stop watching and release the published snapshot. Snapshots taken
+ * by readers remain valid until put.
+ */
+COMO_API void como_watch_stop( void );
+
+/**
+ * Take reference to the latest snapshot (lock-free).
+ *
+ * @return Snapshot (or NULL if not watching).
+ */
+COMO_API como_snap_t como_snap_get( void );
+
+/**
+ * Release snapshot reference.
+ *
+ * @param snap Snapshot.
+ */
+COMO_API void como_snap_put( como_snap_t snap );
+
+
+/*
+ * Incremental parse functions.
+ */
+
+/**
+ * Parse command line incrementally. Previous parse is restored to the
+ * last token boundary before the first changed argument, and only the
+ * rest of the arguments are parsed.
+ *
+ * Use instead of como_finish().
+ *
+ * @param prev Previous parse (or NULL for first parse).
+ * @param argc Argument count.
+ * @param argv Arguments (with program name).
+ *
+ * @return Parse result (same as prev if given), or NULL if memory is
+ *         not available for first parse. If arguments can't be
+ *         stored, parse fails (EXIT_FAILURE), and next parse starts
+ *         over.
+ */
+COMO_API como_parse_t como_parse( como_parse_t prev, pl_i64_t argc, char** argv );
+
+/**
+ * Release incremental parse and reset results.
+ *
+ * @param parse Parse result.
+ */
+COMO_API void como_parse_end( como_parse_t parse );
+
+
+
+/*
+ * Memory functions.
+ */
+
+/**
+ * Use caller supplied buffer for all como allocations (zero-heap
+ * mode). Must be called before como_init(). Mode ends with
+ * como_end().
+ *
+ * @param buf Buffer (aligned for pointers).
+ * @param size Buffer size.
+ */
+COMO_API void como_use_mem( void* buf, pl_i64_t size );
+
+/**
+ * Return the amount of caller supplied buffer used.
+ *
+ * @return Used bytes (0 if not in zero-heap mode).
+ */
+COMO_API pl_i64_t como_used_mem( void );
+
+/**
+ * Compute upper bound of memory required for command with given
+ * specification and argument count (see: como_use_mem()).
+ *
+ * @param spec Array of option specifications.
+ * @param size Size of the specification array.
+ * @param argc C-main argument count.
+ *
+ * @return Required bytes.
+ */
+COMO_API pl_i64_t como_required_mem( const como_opt_spec_s* spec, pl_i64_t size, pl_i64_t argc );
+
+/**
+ * Compute upper bound of memory required for command set (main
+ * command and subcommands) with given argument count (see:
+ * como_use_mem()).
+ *
+ * @param cmds Command specifications.
+ * @param cnt Command count.
+ * @param argc C-main argument count.
+ *
+ * @return Required bytes.
+ */
+COMO_API pl_i64_t como_required_mem_cmds( const como_cmd_spec_s* cmds, pl_i64_t cnt, pl_i64_t argc );
+
 
 
 /*
@@ -933,7 +2464,7 @@ void como_display_values( FILE* fh, como_opt_t o );
  * @param author Program author.
  * @param year Program creation date (year).
  */
-void como_init( pl_i64_t argc, char** argv, char* author, char* year );
+COMO_API void como_init( pl_i64_t argc, char** argv, char* author, char* year );
 
 
 /**
@@ -944,6 +2475,13 @@ void como_init( pl_i64_t argc, char** argv, char* author, char* year );
  * Subcmd can be configured after this function. If subcmd has a
  * parent, the configuration is inherited from the parent.
  *
+ * Only the specification is registered. Options are created when the
+ * subcmd is entered in parsing or queried (e.g. for usage), hence the
+ * specification array must remain valid as long as como is used, as
+ * a static const table does (see: como_subcmd_table). For temporary
+ * arrays use como_spec_subcmd_copy(). Specification strings are
+ * referenced, not copied.
+ *
  * Example:
  *
  * @code
@@ -959,7 +2497,39 @@ void como_init( pl_i64_t argc, char** argv, char* author, char* year );
  * @param spec Array of option specifications.
  * @param size Size of the specification array.
  */
-void como_spec_subcmd( char* name, char* parentname, como_opt_spec_t spec, pl_i64_t size );
+COMO_API void como_spec_subcmd( char*                  name,
+                       char*                  parentname,
+                       const como_opt_spec_s* spec,
+                       pl_i64_t               size );
+
+/**
+ * Specify subcmd as como_spec_subcmd(), but copy the specification
+ * array to como memory. Used by "como_subcmd" macro, whose array is
+ * a compound literal in the scope of the caller. Specification
+ * strings are referenced, not copied.
+ *
+ * @param name Name.
+ * @param parentname Name of subcmd parent.
+ * @param spec Array of option specifications.
+ * @param size Size of the specification array.
+ */
+COMO_API void como_spec_subcmd_copy( char*                  name,
+                                     char*                  parentname,
+                                     const como_opt_spec_s* spec,
+                                     pl_i64_t               size );
+
+
+/**
+ * Declare subcommand provided by plugin (shared object). Plugin is
+ * loaded when the subcommand is entered in parsing, or when its
+ * options are otherwise needed (e.g. usage). Plugin handler is used
+ * for the subcommand, unless set with como_handler().
+ *
+ * @param name Name.
+ * @param parentname Name of subcmd parent.
+ * @param path Plugin path (for dlopen).
+ */
+COMO_API void como_plugin( char* name, char* parentname, const char* path );
 
 
 
@@ -973,13 +2543,17 @@ void como_spec_subcmd( char* name, char* parentname, como_opt_spec_t spec, pl_i6
  *
  * @param cmd Command to clean.
  */
-void como_cmd_end( como_cmd_t cmd );
+COMO_API void como_cmd_end( como_cmd_t cmd );
 
 
 /**
  * Same as @see como_cmd_end(), but for default
  *
  */
-void como_end( void );
+COMO_API void como_end( void );
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,1056 @@
+#ifndef COMO_HPP
+#define COMO_HPP
+
+/**
+ * @file como.hpp
+ *
+ * @brief C++ front end for como (C++20).
+ *
+ * Option specification is a constexpr array of como_opt_spec_s, and
+ * it is checked at compile time: duplicate names, duplicate switches,
+ * and invalid type combinations are compile errors. Longopts and a
+ * perfect hash table of option names are generated at compile time.
+ *
+ * @code
+ *   static constexpr como_opt_spec_s prog_spec[] = {
+ *       { COMO_SINGLE,     "file",    "-f", "File." },
+ *       { COMO_OPT_SINGLE, "threads", "-t", "Threads." },
+ *       { COMO_SWITCH,     "verbose", "-v", "Verbose." },
+ *   };
+ *
+ *   int main( int argc, char** argv )
+ *   {
+ *       como_init( argc, argv, "Me", "2024" );
+ *       como::command< prog_spec > prog( "prog" );
+ *       como_finish();
+ *
+ *       int threads = prog.get< int >( "threads" );
+ *       ...
+ *   }
+ * @endcode
+ *
+ * Option names in accessors are resolved to option handles (index in
+ * specification) at compile time, and unknown names are compile
+ * errors. Hence the accessors are plain array indexing at runtime.
+ * Names known only at runtime are resolved with the perfect hash
+ * table (see: command::find()).
+ *
+ * Automatic help is enabled as in C (see: como_conf_autohelp()).
+ *
+ * Parse results are accessed through views (value_view, given_view)
+ * that refer to the data held by como core, i.e. nothing is copied or
+ * allocated. Value lengths are computed by core when parsing is
+ * done. Parse context (context) owns como core state and is
+ * move-only.
+ *
+ * @code
+ *   int main( int argc, char** argv )
+ *   {
+ *       como::context ctx( argc, argv, "Me", "2024" );
+ *       como::command< prog_spec > prog( "prog" );
+ *       ctx.finish();
+ *
+ *       for ( como::option o : ctx.given() ) {
+ *           for ( std::string_view v : o.values() ) {
+ *               ...
+ *           }
+ *       }
+ *   }
+ * @endcode
+ */
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "como.h"
+
+
+namespace como
+{
+
+
+/** Option type bits (as opposed to primitive bits). */
+inline constexpr como_opt_type_t type_mask =
+    COMO_SUBCMD | COMO_SWITCH | COMO_SINGLE | COMO_MULTI | COMO_OPT_SINGLE | COMO_OPT_MULTI |
+    COMO_OPT_ANY | COMO_DEFAULT | COMO_EXCLUSIVE | COMO_SILENT | COMO_MAP | COMO_COUNT;
+
+/** Option primitive bits. */
+inline constexpr como_opt_type_t prim_mask = COMO_P_NONE | COMO_P_ONE | COMO_P_MANY |
+                                             COMO_P_OPT | COMO_P_DEFAULT | COMO_P_MUTEX |
+                                             COMO_P_HIDDEN | COMO_P_MAP | COMO_P_COUNT;
+
+
+namespace detail
+{
+
+/**
+ * Length of C string (0 for NULL).
+ *
+ * @param str String.
+ *
+ * @return Length.
+ */
+constexpr std::size_t text_len( const char* str )
+{
+    return str ? std::string_view( str ).size() : 0;
+}
+
+
+/**
+ * Check if C strings are equal (NULLs are not equal to anything).
+ *
+ * @param a First string.
+ * @param b Second string.
+ *
+ * @return True if equal.
+ */
+constexpr bool text_eq( const char* a, const char* b )
+{
+    return a && b && std::string_view( a ) == std::string_view( b );
+}
+
+
+/**
+ * Hash option name (FNV-1a with seed).
+ *
+ * @param name Name.
+ * @param seed Seed.
+ *
+ * @return Hash.
+ */
+constexpr std::uint64_t name_hash( std::string_view name, std::uint64_t seed )
+{
+    std::uint64_t h = 14695981039346656037ULL ^ ( seed * 0x9e3779b97f4a7c15ULL );
+
+    for ( char c : name ) {
+        h ^= static_cast< std::uint8_t >( c );
+        h *= 1099511628211ULL;
+    }
+
+    return h ^ ( h >> 29 );
+}
+
+
+/**
+ * Check option type. Type is a single type bit, or a combination of
+ * primitives with argument count (NONE, ONE, or DEFAULT), where MANY
+ * requires ONE.
+ *
+ * @param type Option type.
+ *
+ * @return True if valid.
+ */
+constexpr bool type_valid( como_opt_type_t type )
+{
+    if ( type & type_mask ) {
+        return ( type & ~type_mask ) == 0 && ( type & ( type - 1 ) ) == 0;
+    }
+
+    if ( type == 0 || ( type & ~prim_mask ) ) {
+        return false;
+    }
+
+    if ( !( type & ( COMO_P_NONE | COMO_P_ONE | COMO_P_DEFAULT ) ) ) {
+        return false;
+    }
+
+    return !( type & COMO_P_MANY ) || ( type & ( COMO_P_ONE | COMO_P_DEFAULT ) );
+}
+
+
+/**
+ * Check if option is default option (no name or switch).
+ *
+ * @param spec Option specification.
+ *
+ * @return True if default.
+ */
+constexpr bool is_default( const como_opt_spec_s& spec )
+{
+    return spec.type == COMO_DEFAULT || ( spec.type & COMO_P_DEFAULT );
+}
+
+/**
+ * Check that all option names are unique.
+ *
+ * @tparam Spec Option specification.
+ *
+ * @return True if unique.
+ */
+template < const auto& Spec >
+consteval bool names_unique()
+{
+    for ( std::size_t i = 0; i < std::size( Spec ); i++ ) {
+        for ( std::size_t j = i + 1; j < std::size( Spec ); j++ ) {
+            if ( text_eq( Spec[ i ].name, Spec[ j ].name ) ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Check if option's longopt (explicit, or generated "--name") equals
+ * text.
+ *
+ * @param spec Option specification.
+ * @param text Switch or longopt (or nullptr).
+ *
+ * @return True if equal.
+ */
+constexpr bool longopt_eq( const como_opt_spec_s& spec, const char* text )
+{
+    if ( spec.longopt ) {
+        return text_eq( spec.longopt, text );
+    }
+
+    if ( !text || is_default( spec ) ) {
+        return false;
+    }
+
+    std::string_view t( text );
+    return t.size() > 2 && t.substr( 0, 2 ) == "--" && t.substr( 2 ) == spec.name;
+}
+
+
+/**
+ * Check if options have the same longopt (explicit or generated).
+ *
+ * @param a Option specification.
+ * @param b Option specification.
+ *
+ * @return True if same.
+ */
+constexpr bool longopt_same( const como_opt_spec_s& a, const como_opt_spec_s& b )
+{
+    if ( a.longopt ) {
+        return longopt_eq( b, a.longopt );
+    }
+
+    if ( is_default( a ) || is_default( b ) ) {
+        return false;
+    }
+
+    return b.longopt ? longopt_eq( a, b.longopt ) : text_eq( a.name, b.name );
+}
+
+
+/**
+ * Check that all switches and longopts (explicit or generated) are
+ * unique, also across each other.
+ *
+ * @tparam Spec Option specification.
+ *
+ * @return True if unique.
+ */
+template < const auto& Spec >
+consteval bool switches_unique()
+{
+    for ( std::size_t i = 0; i < std::size( Spec ); i++ ) {
+        for ( std::size_t j = i + 1; j < std::size( Spec ); j++ ) {
+            if ( text_eq( Spec[ i ].opt, Spec[ j ].opt ) || longopt_same( Spec[ i ], Spec[ j ] ) ||
+                 longopt_eq( Spec[ i ], Spec[ j ].opt ) || longopt_eq( Spec[ j ], Spec[ i ].opt ) ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Check types, names (required except for default), switches (start
+ * with "-", none for subcmd), and that there is at most one default
+ * option.
+ *
+ * @tparam Spec Option specification.
+ *
+ * @return True if valid.
+ */
+template < const auto& Spec >
+consteval bool types_valid()
+{
+    std::size_t defaults = 0;
+
+    for ( const como_opt_spec_s& s : Spec ) {
+        if ( !type_valid( s.type ) ) {
+            return false;
+        }
+        if ( is_default( s ) ) {
+            defaults++;
+        } else if ( text_len( s.name ) == 0 ) {
+            return false;
+        }
+        if ( s.opt && ( s.type == COMO_SUBCMD || s.opt[ 0 ] != '-' ) ) {
+            return false;
+        }
+    }
+
+    return defaults <= 1;
+}
+
+
+/**
+ * Check if longopt is generated for option.
+ *
+ * @param spec Option specification.
+ *
+ * @return True if generated.
+ */
+constexpr bool longopt_generated( const como_opt_spec_s& spec )
+{
+    return !spec.longopt && !is_default( spec );
+}
+
+
+/**
+ * Size of generated longopt storage: "--name" and null for each
+ * generated longopt, and empty string at offset 0.
+ *
+ * @tparam Spec Option specification.
+ *
+ * @return Size.
+ */
+template < const auto& Spec >
+consteval std::size_t longopt_size()
+{
+    std::size_t total = 1;
+
+    for ( const como_opt_spec_s& s : Spec ) {
+        if ( longopt_generated( s ) ) {
+            total += text_len( s.name ) + 3;
+        }
+    }
+
+    return total;
+}
+
+
+/** Generated longopts and their offsets (0 for none). */
+template < std::size_t L, std::size_t N >
+struct longopt_table
+{
+    std::array< char, L >        text{};
+    std::array< std::size_t, N > offset{};
+};
+
+
+/**
+ * Generate longopts.
+ *
+ * @tparam Spec Option specification.
+ *
+ * @return Longopt table.
+ */
+template < const auto& Spec >
+consteval auto make_longopts()
+{
+    longopt_table< longopt_size< Spec >(), std::size( Spec ) > t;
+    std::size_t                                               pos = 1;
+
+    for ( std::size_t i = 0; i < std::size( Spec ); i++ ) {
+        if ( longopt_generated( Spec[ i ] ) ) {
+            t.offset[ i ] = pos;
+            t.text[ pos++ ] = '-';
+            t.text[ pos++ ] = '-';
+            for ( char c : std::string_view( Spec[ i ].name ) ) {
+                t.text[ pos++ ] = c;
+            }
+            t.text[ pos++ ] = '\0';
+        }
+    }
+
+    return t;
+}
+
+
+/** Generated longopts of specification (static storage). */
+template < const auto& Spec >
+inline constexpr auto longopts = make_longopts< Spec >();
+
+
+/**
+ * Specification for como core: user specification with generated
+ * longopts.
+ *
+ * @tparam Spec Option specification.
+ *
+ * @return Specification.
+ */
+template < const auto& Spec >
+consteval auto make_table()
+{
+    std::array< como_opt_spec_s, std::size( Spec ) > t{};
+
+    for ( std::size_t i = 0; i < std::size( Spec ); i++ ) {
+        t[ i ] = Spec[ i ];
+        if ( longopts< Spec >.offset[ i ] ) {
+            t[ i ].longopt = &longopts< Spec >.text[ longopts< Spec >.offset[ i ] ];
+        }
+    }
+
+    return t;
+}
+
+
+/** Specification for como core (static storage). */
+template < const auto& Spec >
+inline constexpr auto table = make_table< Spec >();
+
+
+/**
+ * Perfect hash table size (power of two, at least twice the options).
+ *
+ * @param cnt Number of options.
+ *
+ * @return Size.
+ */
+constexpr std::size_t hash_size( std::size_t cnt )
+{
+    std::size_t n = 4;
+
+    while ( n < 2 * cnt ) {
+        n <<= 1;
+    }
+
+    return n;
+}
+
+
+/** Perfect hash: seed and slots (option index + 1, or 0). */
+template < std::size_t M >
+struct hash_table
+{
+    std::uint64_t                 seed = 0;
+    std::array< std::uint32_t, M > slot{};
+};
+
+
+/**
+ * Search hash seed without collisions for option names.
+ *
+ * @tparam Spec Option specification.
+ *
+ * @return Hash table.
+ */
+template < const auto& Spec >
+consteval auto make_hash()
+{
+    constexpr std::size_t M = hash_size( std::size( Spec ) );
+
+    for ( std::uint64_t seed = 0;; seed++ ) {
+        hash_table< M > t;
+        bool            ok = true;
+
+        t.seed = seed;
+        for ( std::size_t i = 0; ok && i < std::size( Spec ); i++ ) {
+            if ( Spec[ i ].name ) {
+                std::size_t h = name_hash( Spec[ i ].name, seed ) & ( M - 1 );
+                if ( t.slot[ h ] ) {
+                    ok = false;
+                } else {
+                    t.slot[ h ] = i + 1;
+                }
+            }
+        }
+
+        if ( ok ) {
+            return t;
+        }
+    }
+}
+
+
+/** Perfect hash of option names (static storage). */
+template < const auto& Spec >
+inline constexpr auto hash = make_hash< Spec >();
+
+
+/**
+ * Find option index by name.
+ *
+ * @tparam Spec Option specification.
+ * @param name Option name (empty for default option).
+ *
+ * @return Index (size of specification if not found).
+ */
+template < const auto& Spec >
+consteval std::size_t index_of( std::string_view name )
+{
+    for ( std::size_t i = 0; i < std::size( Spec ); i++ ) {
+        if ( name.empty() ? is_default( Spec[ i ] )
+                          : ( Spec[ i ].name && name == Spec[ i ].name ) ) {
+            return i;
+        }
+    }
+
+    return std::size( Spec );
+}
+
+
+} // namespace detail
+
+
+/**
+ * View of option values. Random access range of std::string_view,
+ * where lengths are precomputed by como core.
+ */
+class value_view : public std::ranges::view_interface< value_view >
+{
+public:
+    /** Random access iterator over values. */
+    class iterator
+    {
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::string_view;
+
+        iterator() = default;
+
+        iterator( char* const* value, const pl_size_t* len, difference_type pos )
+            : value_( value ), len_( len ), pos_( pos )
+        {
+        }
+
+        std::string_view operator*() const
+        {
+            return std::string_view( value_[ pos_ ], len_[ pos_ ] );
+        }
+
+        std::string_view operator[]( difference_type n ) const
+        {
+            return *( *this + n );
+        }
+
+        iterator& operator++()
+        {
+            pos_++;
+            return *this;
+        }
+
+        iterator operator++( int )
+        {
+            iterator ret = *this;
+            pos_++;
+            return ret;
+        }
+
+        iterator& operator--()
+        {
+            pos_--;
+            return *this;
+        }
+
+        iterator operator--( int )
+        {
+            iterator ret = *this;
+            pos_--;
+            return ret;
+        }
+
+        iterator& operator+=( difference_type n )
+        {
+            pos_ += n;
+            return *this;
+        }
+
+        iterator& operator-=( difference_type n )
+        {
+            pos_ -= n;
+            return *this;
+        }
+
+        friend iterator operator+( iterator it, difference_type n )
+        {
+            return it += n;
+        }
+
+        friend iterator operator+( difference_type n, iterator it )
+        {
+            return it += n;
+        }
+
+        friend iterator operator-( iterator it, difference_type n )
+        {
+            return it -= n;
+        }
+
+        friend difference_type operator-( const iterator& a, const iterator& b )
+        {
+            return a.pos_ - b.pos_;
+        }
+
+        friend bool operator==( const iterator& a, const iterator& b )
+        {
+            return a.pos_ == b.pos_;
+        }
+
+        friend std::strong_ordering operator<=>( const iterator& a, const iterator& b )
+        {
+            return a.pos_ <=> b.pos_;
+        }
+
+    private:
+        char* const*     value_ = nullptr;
+        const pl_size_t* len_ = nullptr;
+        difference_type  pos_ = 0;
+    };
+
+
+    value_view() = default;
+
+    /**
+     * View values of option.
+     *
+     * @param opt Option.
+     */
+    explicit value_view( como_opt_t opt )
+        : value_( opt->value ), len_( opt->valuelen ), cnt_( opt->valuecnt )
+    {
+    }
+
+    iterator begin() const
+    {
+        return iterator( value_, len_, 0 );
+    }
+
+    iterator end() const
+    {
+        return iterator( value_, len_, cnt_ );
+    }
+
+    std::size_t size() const
+    {
+        return static_cast< std::size_t >( cnt_ );
+    }
+
+private:
+    char* const*     value_ = nullptr;
+    const pl_size_t* len_ = nullptr;
+    std::ptrdiff_t   cnt_ = 0;
+};
+
+
+/**
+ * Option of parse result.
+ */
+class option
+{
+public:
+    /**
+     * Refer to option.
+     *
+     * @param opt Option.
+     */
+    explicit option( como_opt_t opt ) : opt_( opt )
+    {
+    }
+
+    /** Return como option. */
+    como_opt_t opt() const
+    {
+        return opt_;
+    }
+
+    /** Return option name. */
+    std::string_view name() const
+    {
+        return opt_->name ? std::string_view( opt_->name ) : std::string_view();
+    }
+
+    /** Check if option is given. */
+    bool given() const
+    {
+        return opt_->given;
+    }
+
+    /** Return option values. */
+    value_view values() const
+    {
+        return value_view( opt_ );
+    }
+
+private:
+    como_opt_t opt_;
+};
+
+
+/**
+ * View of given options of command (in specification order). Subcmds
+ * are not included (see: como_cmd_given_subcmd()).
+ */
+class given_view : public std::ranges::view_interface< given_view >
+{
+public:
+    /** Forward iterator over given options. */
+    class iterator
+    {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = option;
+        using difference_type = std::ptrdiff_t;
+        using reference = option;
+
+        iterator() = default;
+
+        iterator( como_opt_p pos, como_opt_p end ) : pos_( pos ), end_( end )
+        {
+            skip();
+        }
+
+        option operator*() const
+        {
+            return option( *pos_ );
+        }
+
+        iterator& operator++()
+        {
+            pos_++;
+            skip();
+            return *this;
+        }
+
+        iterator operator++( int )
+        {
+            iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        friend bool operator==( const iterator& a, const iterator& b )
+        {
+            return a.pos_ == b.pos_;
+        }
+
+    private:
+        /** Move to next given option (or end). */
+        void skip()
+        {
+            while ( pos_ != end_ && ( !( *pos_ )->given || ( *pos_ )->type == COMO_SUBCMD ) ) {
+                pos_++;
+            }
+        }
+
+        como_opt_p pos_ = nullptr;
+        como_opt_p end_ = nullptr;
+    };
+
+
+    given_view() = default;
+
+    /**
+     * View given options of command.
+     *
+     * @param cmd Command.
+     */
+    explicit given_view( como_cmd_t cmd )
+    {
+        if ( cmd && cmd->opts ) {
+            begin_ = cmd->opts;
+            end_ = cmd->opts + cmd->optcnt;
+        }
+    }
+
+    iterator begin() const
+    {
+        return iterator( begin_, end_ );
+    }
+
+    iterator end() const
+    {
+        return iterator( end_, end_ );
+    }
+
+private:
+    como_opt_p begin_ = nullptr;
+    como_opt_p end_ = nullptr;
+};
+
+
+/**
+ * Parse context: owns como core state from como_init() to
+ * como_end(). Context is move-only, and moved-from context owns
+ * nothing.
+ */
+class context
+{
+public:
+    /**
+     * Initialize como (see: como_init()).
+     *
+     * @param argc Argument count.
+     * @param argv Arguments.
+     * @param author Program author.
+     * @param year Year (or date) of program.
+     */
+    context( int argc, char** argv, const char* author, const char* year ) : owner_( true )
+    {
+        como_init( argc, argv, const_cast< char* >( author ), const_cast< char* >( year ) );
+    }
+
+    context( const context& ) = delete;
+    context& operator=( const context& ) = delete;
+
+    context( context&& other ) noexcept : owner_( std::exchange( other.owner_, false ) )
+    {
+    }
+
+    context& operator=( context&& other ) noexcept
+    {
+        if ( this != &other ) {
+            release();
+            owner_ = std::exchange( other.owner_, false );
+        }
+        return *this;
+    }
+
+    ~context()
+    {
+        release();
+    }
+
+    /**
+     * Parse and check options (see: como_finish()).
+     */
+    void finish()
+    {
+        como_finish();
+    }
+
+    /** Return main command. */
+    como_cmd_t main() const
+    {
+        return como_main;
+    }
+
+    /** Return given options of main command. */
+    given_view given() const
+    {
+        return given_view( como_main );
+    }
+
+    /** Check if context owns como core state. */
+    explicit operator bool() const
+    {
+        return owner_;
+    }
+
+private:
+    /** Release como core state (if owned). */
+    void release()
+    {
+        if ( owner_ ) {
+            como_end();
+            owner_ = false;
+        }
+    }
+
+    bool owner_;
+};
+
+
+/**
+ * Command with compile time option specification.
+ *
+ * @tparam Spec Option specification array (constexpr).
+ */
+template < const auto& Spec >
+class command
+{
+public:
+    /** Number of options in specification. */
+    static constexpr std::size_t size = std::size( Spec );
+
+    static_assert( size > 0, "como: empty specification" );
+    static_assert( detail::names_unique< Spec >(), "como: duplicate option name" );
+    static_assert( detail::switches_unique< Spec >(), "como: duplicate option switch" );
+    static_assert( detail::types_valid< Spec >(), "como: invalid option type, name, or switch" );
+
+
+    /**
+     * Option key resolved at compile time. Unknown name is a compile
+     * error.
+     */
+    struct key
+    {
+        std::size_t index;
+
+        /**
+         * Resolve option name.
+         *
+         * @param name Option name ("" for default option).
+         */
+        consteval key( const char* name ) : index( detail::index_of< Spec >( name ) )
+        {
+            if ( index == size ) {
+                /* Not a constant expression, i.e. compile error. */
+                throw "como: unknown option name";
+            }
+        }
+    };
+
+
+    /**
+     * Specify command (main command if parent is NULL). Configuration
+     * functions apply to this command until next command is specified.
+     *
+     * @param name Command name.
+     * @param parent Parent command name (or NULL).
+     */
+    explicit command( const char* name, const char* parent = nullptr )
+    {
+        como_spec_subcmd( const_cast< char* >( name ),
+                          const_cast< char* >( parent ),
+                          detail::table< Spec >.data(),
+                          size );
+        cmd_ = como_cmd;
+    }
+
+
+    /**
+     * Return como command.
+     */
+    como_cmd_t cmd() const
+    {
+        return cmd_;
+    }
+
+
+    /**
+     * Return option.
+     *
+     * @param k Option key.
+     *
+     * @return Option.
+     */
+    como_opt_t opt( key k ) const
+    {
+        return como_cmd_opt_at( cmd_, k.index );
+    }
+
+
+    /**
+     * Check if option is given.
+     *
+     * @param k Option key.
+     *
+     * @return True if given.
+     */
+    bool given( key k ) const
+    {
+        return opt( k )->given;
+    }
+
+
+    /**
+     * Return option values.
+     *
+     * @param k Option key.
+     *
+     * @return Values.
+     */
+    value_view values( key k ) const
+    {
+        return value_view( opt( k ) );
+    }
+
+
+    /**
+     * Return given options of command.
+     */
+    given_view given_options() const
+    {
+        return given_view( cmd_ );
+    }
+
+
+    /**
+     * Get option value converted to T: bool (given), integer,
+     * floating point, std::string_view, or const char*. First value
+     * is used for multi value options.
+     *
+     * @param k Option key.
+     * @param def Value if option is not given (or has no value).
+     *
+     * @return Value.
+     */
+    template < typename T >
+    T get( key k, T def = T{} ) const
+    {
+        como_opt_t o = opt( k );
+
+        if constexpr ( std::is_same_v< T, bool > ) {
+            return o->given;
+        } else {
+            if ( !o->given || o->valuecnt == 0 ) {
+                return def;
+            }
+
+            const char* v = o->value[ 0 ];
+
+            if constexpr ( std::is_integral_v< T > ) {
+                return static_cast< T >( std::strtoll( v, nullptr, 0 ) );
+            } else if constexpr ( std::is_floating_point_v< T > ) {
+                return static_cast< T >( std::strtod( v, nullptr ) );
+            } else if constexpr ( std::is_same_v< T, std::string_view > ) {
+                return std::string_view( v, o->valuelen[ 0 ] );
+            } else {
+                static_assert( std::is_same_v< T, const char* >, "como: unsupported value type" );
+                return v;
+            }
+        }
+    }
+
+
+    /**
+     * Find option index by name at runtime (perfect hash).
+     *
+     * @param name Option name.
+     *
+     * @return Index (or COMO_NO_HANDLE).
+     */
+    static como_handle_t find( std::string_view name )
+    {
+        const auto&   h = detail::hash< Spec >;
+        std::uint32_t slot;
+
+        slot = h.slot[ detail::name_hash( name, h.seed ) & ( h.slot.size() - 1 ) ];
+        if ( slot && name == Spec[ slot - 1 ].name ) {
+            return slot - 1;
+        }
+
+        return COMO_NO_HANDLE;
+    }
+
+
+    /**
+     * Return specification passed to como core (with generated
+     * longopts).
+     */
+    static constexpr const como_opt_spec_s* spec()
+    {
+        return detail::table< Spec >.data();
+    }
+
+
+private:
+    como_cmd_t cmd_;
+};
+
+} // namespace como
+
+#endif
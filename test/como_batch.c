@@ -0,0 +1,87 @@
+/**
+ * @file como_batch.c
+ *
+ * Test batch mode: line splitting (quoting), handlers, and output
+ * order with multiple workers.
+ */
+
+#include <plinth.h>
+#include <stdlib.h>
+#include "../src/como.h"
+
+#define BATCH_FILE "como_batch.txt"
+
+
+/**
+ * Add command handler.
+ */
+int add_handler( como_cmd_t cmd, void* arg )
+{
+  fprintf( como_out(), "add (verbose: %s):", como_given( "verbose" ) ? "true" : "false" );
+  for ( char** value = como_cmd_value( cmd, "file" ); *value; value++ )
+    fprintf( como_out(), " [%s]", *value );
+  fprintf( como_out(), "\n" );
+  return 0;
+}
+
+
+/**
+ * Remove command handler.
+ */
+int rm_handler( como_cmd_t cmd, void* arg )
+{
+  if ( !como_cmd_given( cmd, "file" ) )
+    {
+      como_error( "Nothing to remove..." );
+      return 2;
+    }
+  fprintf( como_out(), "rm: [%s]\n", como_cmd_value( cmd, "file" )[ 0 ] );
+  return 0;
+}
+
+
+int main( int argc, char** argv )
+{
+  como_batch_t batch;
+  FILE*        fh;
+
+  fh = fopen( BATCH_FILE, "w" );
+  fprintf( fh, "# Comment line.\n" );
+  fprintf( fh, "como_batch add -f 'a b' \"c \\\"d\\\"\" e\\ f\n" );
+  fprintf( fh, "\n" );
+  fprintf( fh, "  como_batch -v add -f x   # trailing comment\n" );
+  fprintf( fh, "como_batch add -f '' \"$HOME\" 'it'\\''s' \"back\\\\slash\"\n" );
+  fprintf( fh, "como_batch rm -f y\n" );
+  fprintf( fh, "como_batch rm\n" );
+  fprintf( fh, "como_batch -x\n" );
+  fprintf( fh, "como_batch add -f \"unterminated\n" );
+  fclose( fh );
+
+  como_maincmd( "como_batch", "Como Tester", "2013",
+                { COMO_SWITCH, "verbose", "-v", "Verbose." },
+                { COMO_SUBCMD, "add",     NULL, "Add files." },
+                { COMO_SUBCMD, "rm",      NULL, "Remove file." }
+                );
+  como_subcmd( "add", "como_batch",
+               { COMO_MULTI, "file", "-f", "Files." }
+               );
+  como_handler( add_handler, NULL );
+  como_subcmd( "rm", "como_batch",
+               { COMO_OPT_SINGLE, "file", "-f", "File." }
+               );
+  como_handler( rm_handler, NULL );
+
+  batch = como_run_batch( BATCH_FILE, atoi( argv[ 1 ] ) );
+  printf( "Lines: %ld\n", (long)batch->cnt );
+  for ( pl_i64_t i = 0; i < batch->cnt; i++ )
+    {
+      printf( "---- %ld (status %d):\n", (long)i, batch->status[ i ] );
+      fputs( batch->output[ i ], stdout );
+    }
+
+  como_batch_end( batch );
+  como_end();
+  remove( BATCH_FILE );
+
+  return 0;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file como_check.c
+ *
+ * Test declarative option value checks.
+ */
+
+#include <plinth.h>
+#include "../src/como.h"
+
+int main( int argc, char** argv )
+{
+  como_opt_p opts;
+  como_opt_t o;
+
+  como_command( "como_check", "Como Tester", "2013",
+                { COMO_OPT_SINGLE, "level", "-l", "Level.", COMO_CHECK_ENUM( "low", "medium", "high", "max" ) },
+                { COMO_OPT_MULTI, "count", "-c", "Counts.", COMO_CHECK_RANGE( 1, 100 ) },
+                { COMO_OPT_SINGLE, "size", "-s", "Buffer size.", COMO_CHECK_SIZE( 1024, 1LL << 30 ) },
+                { COMO_OPT_SINGLE, "timeout", "-t", "Timeout.", COMO_CHECK_DURATION( 100, 3600 * 1000 ) },
+                { COMO_OPT_SINGLE, "name", "-n", "Name.", COMO_CHECK_REGEX( "^[a-z][a-z0-9_]*$" ) },
+                { COMO_OPT_SINGLE, "mode", "-m", "Mode.", COMO_CHECK_ENUM( "fast", "safe", "fast" ) },
+                { COMO_OPT_SINGLE, "unit", "-u", "Unit.",
+                  COMO_CHECK_ENUM( "b", "kb", "mb", "gb", "tb", "pb", "eb", "kib", "mib", "gib",
+                                   "tib", "pib", "eib", "ns", "us", "ms", "s", "min", "h", "d",
+                                   "w", "mo", "y", "hz", "khz", "mhz", "ghz", "ms" ) },
+                { COMO_DEFAULT, NULL, NULL, "Numbers.", COMO_CHECK_RANGE( -10, 10 ) },
+                );
+
+  opts = como_cmd->opts;
+  while ( *opts )
+    {
+      o = *opts;
+
+      printf( "Given \"%s\": %s\n", o->name, o->given ? "true" : "false" );
+
+      if ( o->given && o->value )
+        {
+          printf( "Value \"%s\": ", o->name );
+          como_display_values( stdout, o );
+          printf( "\n" );
+        }
+
+      opts++;
+    }
+
+  como_end();
+
+  return 0;
+}
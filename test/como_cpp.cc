@@ -0,0 +1,67 @@
+/**
+ * @file como_cpp.cc
+ *
+ * Test C++ front end (como.hpp).
+ */
+
+#include <cstdio>
+#include <string>
+#include "../src/como.hpp"
+
+
+static constexpr como_opt_spec_s prog_spec[] = {
+  { COMO_OPT_MULTI,  "file",    "-f", "Files." },
+  { COMO_OPT_SINGLE, "threads", "-t", "Threads." },
+  { COMO_SWITCH,     "verbose", "-v", "Verbose." },
+  { COMO_SUBCMD,     "add",     nullptr, "Add." },
+};
+
+static constexpr como_opt_spec_s add_spec[] = {
+  { COMO_SWITCH, "force", "-fo", "Force." },
+};
+
+
+/* Switches and longopts (explicit or generated) are unique. */
+static constexpr como_opt_spec_s dup_switch[] = {
+  { COMO_SWITCH, "a", "-x", "A." },
+  { COMO_SWITCH, "b", "-x", "B." },
+};
+static constexpr como_opt_spec_s dup_generated[] = {
+  { COMO_SWITCH, "file", "-f",     "File." },
+  { COMO_SWITCH, "fast", "--file", "Fast." },
+};
+static constexpr como_opt_spec_s dup_explicit[] = {
+  { COMO_SWITCH, "file", "-f", "File.", nullptr, "--fast" },
+  { COMO_SWITCH, "fast", "-a", "Fast." },
+};
+
+static_assert( como::detail::switches_unique< prog_spec >() );
+static_assert( !como::detail::switches_unique< dup_switch >() );
+static_assert( !como::detail::switches_unique< dup_generated >() );
+static_assert( !como::detail::switches_unique< dup_explicit >() );
+
+
+int main( int argc, char** argv )
+{
+  como::context              ctx( argc, argv, "Como Tester", "2013" );
+  como::command< prog_spec > prog( "como_cpp" );
+  como::command< add_spec >  add( "add", "como_cpp" );
+
+  ctx.finish();
+
+  printf( "threads: %d\n", prog.get< int >( "threads", 4 ) );
+  printf( "verbose: %s\n", prog.get< bool >( "verbose" ) ? "true" : "false" );
+  printf( "force: %s\n", add.get< bool >( "force" ) ? "true" : "false" );
+  printf( "longopt: %s\n", prog.spec()[ 1 ].longopt );
+  printf( "find: %ld %ld\n", (long)prog.find( "verbose" ), (long)prog.find( "none" ) );
+
+  for ( como::option o : ctx.given() )
+    {
+      printf( "%.*s:", (int)o.name().size(), o.name().data() );
+      for ( std::string_view v : o.values() )
+        printf( " [%.*s]", (int)v.size(), v.data() );
+      printf( "\n" );
+    }
+
+  return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file como_freeze.c
+ *
+ * Test frozen (read-only) parse results.
+ */
+
+#include <plinth.h>
+#include "../src/como.h"
+
+int main( int argc, char** argv )
+{
+  como_cmd_t  cmd;
+  como_opt_t  o;
+  char**      ext;
+  const char* names[] = { "file", "dir", "verbose", NULL };
+
+  como_maincmd( "como_freeze", "Como Tester", "2013",
+               { COMO_SINGLE, "file",    "-f", "File name." },
+               { COMO_MULTI,  "dir",     "-d", "Directories." },
+               { COMO_SWITCH, "verbose", "-v", "Verbose." },
+               );
+
+  como_finish();
+
+  cmd = como_freeze();
+  printf( "Frozen: %s\n", ( cmd && cmd == como_main ) ? "true" : "false" );
+
+  for ( int i = 0; names[ i ]; i++ )
+    {
+      o = como_given( (char*)names[ i ] );
+      printf( "  %s:", names[ i ] );
+      if ( o )
+        for ( int j = 0; j < o->valuecnt; j++ )
+          printf( " %s", o->value[ j ] );
+      else
+        printf( " <not given>" );
+      printf( "\n" );
+    }
+
+  ext = como_external();
+  printf( "External:" );
+  for ( int i = 0; ext && ext[ i ]; i++ )
+    printf( " %s", ext[ i ] );
+  printf( "\n" );
+
+  /* Error reporting and configuration remain usable. */
+  if ( cmd && como_given( "verbose" ) )
+    {
+      como_conf_help_exit( pl_false );
+      como_conf_header( "Frozen results.\n\n" );
+      como_error( "Verbose not supported" );
+      como_usage();
+      printf( "Errors: %d\n", (int)cmd->errors );
+    }
+
+  como_end();
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file como_handle.c
+ *
+ * Test option handles, including out of range handles.
+ */
+
+#include <plinth.h>
+#include "../src/como.h"
+
+
+enum { OPT_FILE, OPT_DEBUG, OPT_SUB };
+enum { SUB_FORCE, SUB_NAME };
+
+
+/**
+ * Display option by handle.
+ */
+void display_handle( como_cmd_t cmd, como_handle_t handle )
+{
+  como_opt_t o;
+  char**     value;
+
+  o = como_cmd_opt_at( cmd, handle );
+  printf( "  %ld:", (long)handle );
+  if ( !o )
+    {
+      printf( " <out of range>\n" );
+      return;
+    }
+
+  printf( " %s", o->name );
+  if ( como_cmd_given_at( cmd, handle ) )
+    {
+      printf( " given" );
+      for ( value = como_cmd_value_at( cmd, handle ); *value; value++ )
+        printf( " %s", *value );
+    }
+  printf( "\n" );
+}
+
+
+int main( int argc, char** argv )
+{
+  const char*   names[] = { "name", "missing", "force" };
+  como_handle_t handles[ 3 ];
+  como_cmd_t    sub;
+
+  como_maincmd( "como_handle", "Como Tester", "2013",
+                { COMO_OPT_SINGLE, "file",  "-f", "File." },
+                { COMO_SWITCH,     "debug", "-d", "Debug." },
+                { COMO_SUBCMD,     "sub",   NULL, "Subcommand." }
+                );
+
+  como_subcmd( "sub", "como_handle",
+               { COMO_SWITCH,    "force", "-fo", "Force." },
+               { COMO_OPT_MULTI, "name",  "-n",  "Names." }
+               );
+  como_conf_autohelp( pl_false );
+
+  como_finish();
+
+  printf( "Main:\n" );
+  for ( como_handle_t h = COMO_NO_HANDLE; h <= OPT_SUB + 1; h++ )
+    display_handle( como_main, h );
+  printf( "  debug: %s\n", como_given_at( OPT_DEBUG ) ? "given" : "not given" );
+  printf( "  value: %s\n", como_value_at( OPT_SUB + 1 ) ? "found" : "<out of range>" );
+
+  /* No automatic help, i.e. help handle is out of range. */
+  sub = como_cmd_subcmd( como_main, "sub" );
+  printf( "Sub:\n" );
+  for ( como_handle_t h = COMO_NO_HANDLE; h <= SUB_NAME + 1; h++ )
+    display_handle( sub, h );
+
+  printf( "Resolved: %ld\n", (long)como_resolve( sub, names, handles, 3 ) );
+  for ( int i = 0; i < 3; i++ )
+    printf( "  %s: %ld\n", names[ i ], (long)handles[ i ] );
+
+  como_end();
+
+  return 0;
+}
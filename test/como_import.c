@@ -0,0 +1,122 @@
+/**
+ * @file como_import.c
+ *
+ * Test export and import of parse results, and import of corrupt
+ * buffers.
+ */
+
+#include <plinth.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/como.h"
+
+
+/**
+ * Display given options of command and its subcmds.
+ */
+void display_options( como_cmd_t cmd )
+{
+  como_cmd_t subcmd;
+
+  printf( "Options for: %s\n", cmd->longname );
+  for ( como_opt_p opts = cmd->opts; *opts; opts++ )
+    if ( ( *opts )->given )
+      {
+        printf( "  %s:", ( *opts )->name );
+        for ( int j = 0; j < ( *opts )->valuecnt; j++ )
+          printf( " %s", ( *opts )->value[ j ] );
+        printf( "\n" );
+      }
+
+  subcmd = como_cmd_given_subcmd( cmd );
+  if ( subcmd )
+    display_options( subcmd );
+}
+
+
+/**
+ * Touch all strings and references of imported command tree.
+ */
+pl_u64_t walk( como_cmd_t cmd )
+{
+  pl_u64_t sum = 0;
+
+  sum += cmd->name ? strlen( cmd->name ) : 0;
+  sum += cmd->longname ? strlen( cmd->longname ) : 0;
+  for ( como_opt_p opts = cmd->opts; *opts; opts++ )
+    {
+      sum += ( *opts )->name ? strlen( ( *opts )->name ) : 0;
+      sum += ( *opts )->doc ? strlen( ( *opts )->doc ) : 0;
+      for ( int j = 0; j < ( *opts )->valuecnt; j++ )
+        sum += strlen( ( *opts )->value[ j ] );
+    }
+  for ( pl_u32_t i = 0; i < cmd->ordercnt; i++ )
+    sum += cmd->order[ i ]->valuecnt;
+  for ( como_cmd_p sub = plcm_data( &cmd->subcmds ); (pl_t)sub < plcm_end( &cmd->subcmds ); sub++ )
+    sum += walk( *sub );
+
+  return sum;
+}
+
+
+int main( int argc, char** argv )
+{
+  como_cmd_t origin;
+  como_cmd_t cmd;
+  pl_i64_t   size;
+  char*      buf;
+  int        accepted = 0;
+  int        rejected = 0;
+
+  como_maincmd( "como_import", "Como Tester", "2013",
+                { COMO_OPT_SINGLE, "file", "-f", "File name." },
+                { COMO_OPT_MULTI,  "dir",  "-d", "Directories." },
+                { COMO_SUBCMD,     "add",  NULL, "Add file." }
+                );
+  como_subcmd( "add", "como_import",
+               { COMO_SWITCH, "force", "-fo", "Force." },
+               { COMO_DEFAULT, NULL,   NULL,  "Names." }
+               );
+
+  como_finish();
+  origin = como_main;
+
+  size = como_export( NULL, 0 );
+  buf = malloc( size );
+  memset( buf, 0, size );
+  como_export( buf, size );
+
+  /* Round-trip. */
+  cmd = como_import( buf, size );
+  printf( "Import: %s\n", cmd ? "ok" : "failed" );
+  if ( cmd )
+    {
+      display_options( cmd );
+      como_import_end( cmd );
+    }
+
+  /* Truncated and corrupt buffers. */
+  printf( "Truncated: %s\n", como_import( buf, size - 1 ) ? "accepted" : "rejected" );
+  for ( pl_i64_t i = 0; i < size; i++ )
+    {
+      buf[ i ] ^= 0xa5;
+      cmd = como_import( buf, size );
+      if ( cmd )
+        {
+          walk( cmd );
+          como_import_end( cmd );
+          accepted++;
+        }
+      else
+        rejected++;
+      buf[ i ] ^= 0xa5;
+    }
+  printf( "Corrupt: %s\n", ( accepted + rejected == size && rejected > 0 ) ? "ok" : "failed" );
+
+  free( buf );
+  como_main = origin;
+  como_cmd = origin;
+  como_end();
+
+  return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file como_map.c
+ *
+ * Test map (key=value) options.
+ */
+
+#include <string.h>
+#include <plinth.h>
+#include "../src/como.h"
+
+/**
+ * Display map option keys.
+ */
+void display_map( como_opt_t o )
+{
+  const char* keys[] = { "foo", "dii", "size", "fo", "missing", NULL };
+
+  printf( "Given \"params\": %s\n", o->given ? "true" : "false" );
+  printf( "Keys: %d\n", como_map( o ) ? (int)como_map( o )->cnt : 0 );
+
+  for ( int i = 0; keys[ i ]; i++ )
+    {
+      const char* value = como_map_get( o, keys[ i ] );
+      printf( "  \"%s\": %s\n", keys[ i ], value ? value : "<none>" );
+    }
+}
+
+
+int main( int argc, char** argv )
+{
+
+  como_maincmd( "como_map", "Como Tester", "2013",
+               { COMO_MAP,    "params", "-p", "Parameters." },
+               { COMO_SWITCH, "first",  "-f", "First duplicate is used." },
+               { COMO_SWITCH, "error",  "-e", "Duplicates are errors." },
+               );
+
+  /* Policy from the command line for testing. */
+  for ( int i = 1; i < argc; i++ )
+    {
+      if ( strcmp( argv[ i ], "-f" ) == 0 )
+        como_conf_map_dup( COMO_MAP_DUP_FIRST );
+      else if ( strcmp( argv[ i ], "-e" ) == 0 )
+        como_conf_map_dup( COMO_MAP_DUP_ERROR );
+    }
+
+  como_finish();
+
+  display_map( como_opt( "params" ) );
+
+  /* Frozen (imported) results resolve duplicates the same way. */
+  como_freeze();
+  printf( "Frozen:\n" );
+  display_map( como_opt( "params" ) );
+
+  como_end();
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file como_mem.c
+ *
+ * Test zero-heap mode (caller supplied memory).
+ */
+
+#include <plinth.h>
+#include "../src/como.h"
+
+static const como_opt_spec_s main_spec[] = {
+  { COMO_SWITCH,    "verbose", "-v", "Verbose." },
+  { COMO_OPT_MULTI, "file",    "-f", "Files." },
+  { COMO_SUBCMD,    "run",     NULL, "Run subcommand." },
+};
+
+static const como_opt_spec_s run_spec[] = {
+  { COMO_SINGLE,    "target",  "-t", "Target." },
+  { COMO_MAP,       "define",  "-D", "Definitions." },
+  { COMO_DEFAULT,   NULL,      NULL, "Arguments." },
+};
+
+static const como_cmd_spec_s cmds[] = {
+  { "como_mem", NULL,       main_spec, COMO_SPEC_SIZE( main_spec ) },
+  { "run",      "como_mem", run_spec,  COMO_SPEC_SIZE( run_spec ) },
+};
+
+static pl_u64_t mem[ 8192 ];
+
+void display( como_cmd_t cmd )
+{
+  como_opt_p opts;
+  como_opt_t o;
+
+  opts = cmd->opts;
+  while ( *opts )
+    {
+      o = *opts;
+
+      if ( o->given && o->type != COMO_SUBCMD )
+        {
+          printf( "  \"%s\"", o->name );
+          if ( o->valuecnt > 0 )
+            {
+              printf( ": " );
+              como_display_values( stdout, o );
+            }
+          printf( "\n" );
+        }
+
+      opts++;
+    }
+}
+
+int main( int argc, char** argv )
+{
+  pl_i64_t   size;
+  como_cmd_t cmd;
+
+  size = como_required_mem_cmds( cmds, 2, argc );
+  if ( size > (pl_i64_t)sizeof( mem ) )
+    {
+      printf( "Required memory too large: %ld\n", (long)size );
+      return 1;
+    }
+
+  como_use_mem( mem, size );
+
+  como_init( argc, argv, "Como Tester", "2013" );
+  for ( int i = 0; i < 2; i++ )
+    como_spec_subcmd( cmds[ i ].name, cmds[ i ].parent, cmds[ i ].spec, cmds[ i ].size );
+  como_finish();
+
+  for ( cmd = como_main; cmd; cmd = como_cmd_given_subcmd( cmd ) )
+    {
+      printf( "Command \"%s\":\n", cmd->name );
+      display( cmd );
+    }
+
+  printf( "Within bound: %s\n", como_used_mem() <= size ? "true" : "false" );
+
+  como_end();
+
+  return 0;
+}
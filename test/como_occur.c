@@ -0,0 +1,70 @@
+/**
+ * @file como_occur.c
+ *
+ * Test option occurrences, counting, and occurrence iteration.
+ */
+
+#include <plinth.h>
+#include "../src/como.h"
+
+
+/**
+ * Display option occurrences in command line order.
+ */
+void display_order( como_cmd_t cmd )
+{
+  como_iter_s it;
+
+  printf( "Order for: %s\n", cmd->longname );
+  como_iter_init( &it, cmd );
+  while ( como_iter_next( &it ) )
+    {
+      printf( "  %u %s:", it.occur->idx, it.opt->name );
+      for ( pl_u32_t i = 0; i < it.occur->valuecnt; i++ )
+        printf( " %s", it.opt->value[ it.occur->value + i ] );
+      printf( "\n" );
+    }
+}
+
+
+int main( int argc, char** argv )
+{
+  como_cmd_t cmd;
+  como_opt_t o;
+
+  como_maincmd( "como_occur", "Como Tester", "2013",
+                { COMO_COUNT,     "verbose", "-v", "Verbosity." },
+                { COMO_OPT_MULTI, "include", "-i", "Include patterns." },
+                { COMO_OPT_MULTI, "exclude", "-e", "Exclude patterns." },
+                { COMO_DEFAULT,   NULL,      NULL, "Files." },
+                { COMO_SUBCMD,    "run",     NULL, "Run." }
+                );
+  como_conf_subcheck( pl_false );
+
+  como_subcmd( "run", "como_occur",
+               { COMO_COUNT,  "quiet", "-q", "Quietness." },
+               { COMO_SINGLE, "file",  "-f", "File." }
+               );
+
+  como_finish();
+
+  printf( "Count verbose: %ld\n", (long)como_count( "verbose" ) );
+  o = como_opt( "include" );
+  printf( "Occurrences include: %ld\n", (long)o->occurcnt );
+
+  display_order( como_main );
+  cmd = como_given_subcmd();
+  if ( cmd )
+    {
+      printf( "Count quiet: %ld\n", (long)como_cmd_count( cmd, "quiet" ) );
+      display_order( cmd );
+    }
+
+  /* Occurrences are kept in frozen results. */
+  como_freeze();
+  display_order( como_main );
+
+  como_end();
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file como_optmem.c
+ *
+ * Test option memory of a large specification. Validators, maps, and
+ * bound fields are in side entries, hence options without them don't
+ * reserve space for them.
+ */
+
+#include <plinth.h>
+#include "../src/como.h"
+
+#define OPT_CNT 2000
+#define COLD_EVERY 100
+
+static como_opt_spec_s spec[ OPT_CNT ];
+static char            names[ OPT_CNT ][ 16 ];
+static pl_u64_t        mem[ 256 * 1024 ];
+
+static const como_check_s range = { COMO_CHECK_KIND_RANGE, NULL, 0, 100, NULL };
+
+
+int main( int argc, char** argv )
+{
+  pl_i64_t   size, cold, inline_size;
+  como_opt_t o;
+
+  cold = 0;
+  for ( int i = 0; i < OPT_CNT; i++ )
+    {
+      sprintf( names[ i ], "opt%d", i );
+      spec[ i ].type = COMO_OPT_SINGLE;
+      spec[ i ].name = names[ i ];
+      spec[ i ].doc = "Option.";
+      if ( i % COLD_EVERY == 0 )
+        {
+          spec[ i ].check = &range;
+          cold++;
+        }
+    }
+
+  size = como_required_mem( spec, OPT_CNT, argc );
+  if ( size > (pl_i64_t)sizeof( mem ) )
+    {
+      printf( "Required memory too large: %ld\n", (long)size );
+      return 1;
+    }
+
+  como_use_mem( mem, size );
+  como_init( argc, argv, "Como Tester", "2013" );
+  como_spec_subcmd( "como_optmem", NULL, spec, OPT_CNT );
+  como_finish();
+
+  o = como_given( "opt100" );
+  printf( "opt100: %s\n", o ? o->value[ 0 ] : "<not given>" );
+
+  /* Cold fields inline would take side entry less pointer per option. */
+  inline_size = ( OPT_CNT + 1 ) * ( sizeof( como_opt_ext_s ) - sizeof( como_opt_ext_t ) );
+  printf( "Options: %d (%ld with validator)\n", OPT_CNT + 1, (long)cold );
+  printf( "Option: %ld bytes, side entry: %ld bytes\n",
+          (long)sizeof( como_opt_s ), (long)sizeof( como_opt_ext_s ) );
+  printf( "Side entries: %ld bytes, inline: %ld bytes\n",
+          (long)( cold * sizeof( como_opt_ext_s ) ), (long)inline_size );
+  printf( "Used: %ld bytes per option\n", (long)( como_used_mem() / ( OPT_CNT + 1 ) ) );
+  printf( "Reduced: %s\n", cold * (pl_i64_t)sizeof( como_opt_ext_s ) < inline_size ? "true" : "false" );
+  printf( "Within bound: %s\n", como_used_mem() <= size ? "true" : "false" );
+
+  como_end();
+
+  return 0;
+}
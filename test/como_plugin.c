@@ -0,0 +1,48 @@
+/**
+ * @file como_plugin.c
+ *
+ * Test plugin subcommands. Plugin "db" is not available, and plugin
+ * "stats" is built from como_plugin_so.c next to the program.
+ */
+
+#include <string.h>
+#include <plinth.h>
+#include "../src/como.h"
+
+int main( int argc, char** argv )
+{
+  como_cmd_t cmd;
+  char       path[ 1024 ];
+  char*      slash;
+
+  /* Plugin is next to the program. */
+  slash = strrchr( argv[ 0 ], '/' );
+  snprintf( path, sizeof( path ), "%.*scomo_plugin.so",
+            slash ? (int)( slash - argv[ 0 ] + 1 ) : 0, argv[ 0 ] );
+
+  como_maincmd( "como_plugin", "Como Tester", "2013",
+                { COMO_SWITCH, "verbose", "-v", "Verbose." },
+                { COMO_SUBCMD, "add",     NULL, "Add file." },
+                { COMO_SUBCMD, "db",      NULL, "Database tools (plugin)." },
+                { COMO_SUBCMD, "stats",   NULL, "Statistics (plugin)." }
+                );
+
+  como_subcmd( "add", "como_plugin",
+               { COMO_SINGLE, "file", "-f", "File." }
+               );
+
+  como_plugin( "db", "como_plugin", "./como_plugin_db.so" );
+  como_plugin( "stats", "como_plugin", path );
+
+  como_finish();
+
+  cmd = como_given_subcmd();
+  printf( "Given: %s\n", cmd ? cmd->longname : "<none>" );
+  if ( cmd && cmd->handler ) {
+    cmd->handler( cmd, cmd->handler_arg );
+  }
+
+  como_end();
+
+  return 0;
+}
@@ -0,0 +1,23 @@
+/**
+ * @file como_plugin_so.c
+ *
+ * Plugin for plugin subcommand test (built as test/como_plugin.so).
+ */
+
+#include <stdio.h>
+#include <plinth.h>
+#include "../src/como.h"
+
+/* Handler uses como from the host program (linked with -rdynamic). */
+static int stats_handler( como_cmd_t cmd, void* arg )
+{
+  printf( "Stats: all=%s table=%s\n",
+          como_cmd_given( cmd, "all" ) ? "yes" : "no",
+          como_cmd_given( cmd, "table" ) ? como_cmd_value( cmd, "table" )[ 0 ] : "<none>" );
+
+  return 0;
+}
+
+como_plugin_define( stats_handler,
+                    { COMO_SWITCH,     "all",   "-a", "All tables." },
+                    { COMO_OPT_SINGLE, "table", "-t", "Table name." } );
@@ -0,0 +1,64 @@
+/**
+ * @file como_reparse.c
+ *
+ * Test incremental parsing. Command line is parsed as if it was typed
+ * one argument at a time, and finally with last argument edited.
+ */
+
+#include <string.h>
+#include <plinth.h>
+#include "../src/como.h"
+
+int main( int argc, char** argv )
+{
+  como_parse_t parse = NULL;
+  char*        line[ 64 ];
+  char*        edit = "edited";
+  char*        names[] = { "file", "dir", "verbose", "level", NULL };
+  como_opt_t   o;
+
+  como_maincmd( "como_reparse", "Como Tester", "2013",
+               { COMO_SINGLE,     "file",    "-f", "File name." },
+               { COMO_MULTI,      "dir",     "-d", "Directories." },
+               { COMO_SWITCH,     "verbose", "-v", "Verbose." },
+               { COMO_OPT_SINGLE, "level",   "-l", "Level." },
+               );
+
+  for ( int n = 1; n <= argc && n < 64; n++ )
+    {
+      memcpy( line, argv, n * sizeof( char* ) );
+      line[ n ] = NULL;
+      parse = como_parse( parse, n, line );
+      printf( "Args %d: status %d, reused %d\n", n - 1, parse->status,
+              (int)parse->reused );
+    }
+
+  if ( argc > 1 && argc < 64 )
+    {
+      line[ argc - 1 ] = edit;
+      parse = como_parse( parse, argc, line );
+      printf( "Edited: status %d, reused %d\n", parse->status,
+              (int)parse->reused );
+    }
+
+  if ( parse->status == 0 )
+    {
+      for ( int i = 0; names[ i ]; i++ )
+        {
+          o = como_opt( names[ i ] );
+          printf( "  %s:", names[ i ] );
+          for ( int j = 0; j < o->valuecnt; j++ )
+            printf( " %s (%d)", o->value[ j ], (int)o->valuelen[ j ] );
+          printf( "%s\n", o->given ? "" : " <not given>" );
+        }
+    }
+  else
+    {
+      fputs( parse->msg, stdout );
+    }
+
+  como_parse_end( parse );
+  como_end();
+
+  return 0;
+}
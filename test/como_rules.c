@@ -0,0 +1,47 @@
+/**
+ * @file como_rules.c
+ *
+ * Test option constraint rules.
+ */
+
+#include <plinth.h>
+#include "../src/como.h"
+
+int main( int argc, char** argv )
+{
+  como_opt_p opts;
+  como_opt_t o;
+
+  como_maincmd( "como_rules", "Como Tester", "2013",
+               { COMO_OPT_SINGLE, "user",     "-u", "User." },
+               { COMO_OPT_SINGLE, "password", "-p", "Password." },
+               { COMO_SWITCH,     "quiet",    "-q", "Quiet." },
+               { COMO_SWITCH,     "verbose",  "-v", "Verbose." },
+               { COMO_SWITCH,     "debug",    "-d", "Debug." },
+               { COMO_SWITCH,     "tar",      "-t", "Tar format." },
+               { COMO_SWITCH,     "zip",      "-z", "Zip format." },
+               { COMO_OPT_SINGLE, "file",     "-f", "File." },
+               { COMO_OPT_SINGLE, "url",      "-r", "Url." },
+               );
+
+  como_rule_requires( "user", "password" );
+  como_rule_conflicts( "quiet", "verbose", "debug" );
+  como_rule_at_most_one( "tar", "zip" );
+  como_rule_at_least_one( "file", "url" );
+
+  como_finish();
+
+  opts = como_cmd->opts;
+  while ( *opts )
+    {
+      o = *opts;
+
+      printf( "Given \"%s\": %s\n", o->name, o->given ? "true" : "false" );
+
+      opts++;
+    }
+
+  como_end();
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file como_serve.c
+ *
+ * Test server mode: requests from client, and malformed requests.
+ */
+
+#include <plinth.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "../src/como.h"
+
+#define SOCK_FILE "como_serve.sock"
+
+
+/**
+ * Status command handler.
+ */
+int status_handler( como_cmd_t cmd, void* arg )
+{
+  printf( "Status: verbose=%s\n", como_cmd_given( cmd, "verbose" ) ? "true" : "false" );
+  return 3;
+}
+
+
+/**
+ * Stop command handler.
+ */
+int stop_handler( como_cmd_t cmd, void* arg )
+{
+  como_serve_stop();
+  return 0;
+}
+
+
+/**
+ * Connect to server.
+ */
+int sock_connect( void )
+{
+  struct sockaddr_un addr;
+  int fd;
+
+  memset( &addr, 0, sizeof( addr ) );
+  addr.sun_family = AF_UNIX;
+  strcpy( addr.sun_path, SOCK_FILE );
+  fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+  if ( connect( fd, (struct sockaddr*)&addr, sizeof( addr ) ) != 0 )
+    {
+      close( fd );
+      return -1;
+    }
+  return fd;
+}
+
+
+/**
+ * Send raw request (header layout of server) and return reply status
+ * (or -1 if connection was closed).
+ */
+int send_raw( pl_u32_t argc, pl_u32_t envc, pl_u32_t size, const char* payload, pl_u32_t len )
+{
+  pl_u32_t        hdr[ 4 ] = { 0x53524f43, argc, envc, size };
+  int             fds[ 3 ] = { 0, 1, 2 };
+  char            ctrl[ CMSG_SPACE( sizeof( fds ) ) ];
+  struct msghdr   msg;
+  struct iovec    iov;
+  struct cmsghdr* cm;
+  int             fd, status;
+
+  fd = sock_connect();
+  memset( &msg, 0, sizeof( msg ) );
+  memset( ctrl, 0, sizeof( ctrl ) );
+  iov.iov_base = hdr;
+  iov.iov_len = sizeof( hdr );
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = ctrl;
+  msg.msg_controllen = sizeof( ctrl );
+  cm = CMSG_FIRSTHDR( &msg );
+  cm->cmsg_level = SOL_SOCKET;
+  cm->cmsg_type = SCM_RIGHTS;
+  cm->cmsg_len = CMSG_LEN( sizeof( fds ) );
+  memcpy( CMSG_DATA( cm ), fds, sizeof( fds ) );
+
+  sendmsg( fd, &msg, MSG_NOSIGNAL );
+  send( fd, payload, len, MSG_NOSIGNAL );
+  if ( recv( fd, &status, sizeof( status ), MSG_WAITALL ) != sizeof( status ) )
+    status = -1;
+  close( fd );
+
+  return status;
+}
+
+
+int main( int argc, char** argv )
+{
+  char*       status_argv[] = { "como_serve", "status", "-v", NULL };
+  char*       bad_argv[] = { "como_serve", "status", "-x", NULL };
+  char*       stop_argv[] = { "como_serve", "stop", NULL };
+  struct stat st;
+  pid_t       pid;
+  int         fd;
+
+  setvbuf( stdout, NULL, _IONBF, 0 );
+  remove( SOCK_FILE );
+
+  pid = fork();
+  if ( pid == 0 )
+    {
+      como_maincmd( "como_serve", "Como Tester", "2013",
+                    { COMO_SUBCMD, "status", NULL, "Show status." },
+                    { COMO_SUBCMD, "stop",   NULL, "Stop server." }
+                    );
+      como_subcmd( "status", "como_serve",
+                   { COMO_SWITCH, "verbose", "-v", "Verbose." }
+                   );
+      como_handler( status_handler, NULL );
+      como_subcmd( "stop", "como_serve",
+                   { COMO_SWITCH, "force", "-f", "Force." }
+                   );
+      como_handler( stop_handler, NULL );
+      exit( como_serve( SOCK_FILE ) );
+    }
+
+  /* Wait for server. */
+  for ( int i = 0; i < 500; i++ )
+    {
+      fd = sock_connect();
+      if ( fd >= 0 )
+        {
+          close( fd );
+          break;
+        }
+      usleep( 10000 );
+    }
+
+  stat( SOCK_FILE, &st );
+  printf( "Socket mode: %o\n", (unsigned)( st.st_mode & 0777 ) );
+
+  printf( "Request: %d\n", como_client( SOCK_FILE, 3, status_argv ) );
+  printf( "Request: %d\n", como_client( SOCK_FILE, 3, bad_argv ) );
+
+  /* No program name. */
+  printf( "Malformed: %d\n", send_raw( 0, 0, 2, "/", 2 ) );
+  /* More arguments than strings. */
+  printf( "Malformed: %d\n", send_raw( 3, 0, 4, "/\0a", 4 ) );
+  /* Payload is not terminated. */
+  printf( "Malformed: %d\n", send_raw( 1, 0, 4, "/\0ab", 4 ) );
+  /* Too large payload. */
+  printf( "Malformed: %d\n", send_raw( 1, 0, 0xffffffff, "/", 2 ) );
+
+  printf( "Request: %d\n", como_client( SOCK_FILE, 3, status_argv ) );
+  printf( "Stop: %d\n", como_client( SOCK_FILE, 2, stop_argv ) );
+
+  waitpid( pid, NULL, 0 );
+
+  return 0;
+}
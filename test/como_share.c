@@ -0,0 +1,66 @@
+/**
+ * @file como_share.c
+ *
+ * Test configuration sharing between commands (shared until modified).
+ */
+
+#include <plinth.h>
+#include "../src/como.h"
+
+void display_conf( como_cmd_t cmd )
+{
+  como_config_t conf = cmd->conf;
+
+  printf( "%-18s %s header=%s footer=%s tab=%ld subcheck=%s\n",
+          cmd->longname,
+          conf == como_main->conf ? "shared" : "own   ",
+          conf->header ? "yes" : "no",
+          conf->footer ? "yes" : "no",
+          (long)conf->tab,
+          conf->subcheck ? "true" : "false" );
+}
+
+int main( int argc, char** argv )
+{
+  como_cmd_t cmd;
+
+  como_maincmd( "como_share", "Como Tester", "2013",
+                { COMO_SWITCH, "verbose", "-v", "Verbose." },
+                { COMO_SUBCMD, "add",     NULL, "Add file." },
+                { COMO_SUBCMD, "rm",      NULL, "Remove file." }
+                );
+  como_conf_header( "\nMain header.\n\n" );
+  como_conf_tab( 14 );
+
+  /* Shares main config. */
+  como_subcmd( "add", "como_share",
+               { COMO_SINGLE, "file", "-f", "File." }
+               );
+
+  /* Own copy, with main header and tab inherited. */
+  como_subcmd( "rm", "como_share",
+               { COMO_SWITCH, "force", "-f", "Force." },
+               { COMO_SUBCMD, "all",   NULL, "Remove all." }
+               );
+  como_conf_footer( "\nRemove footer.\n\n" );
+  como_conf_subcheck( pl_false );
+
+  /* Shares config of "rm". */
+  como_subcmd( "all", "rm",
+               { COMO_SWITCH, "dry", "-n", "Dry run." }
+               );
+
+  como_finish();
+
+  display_conf( como_main );
+  display_conf( como_cmd_subcmd( como_main, "add" ) );
+  cmd = como_cmd_subcmd( como_main, "rm" );
+  display_conf( cmd );
+  display_conf( como_cmd_subcmd( cmd, "all" ) );
+  printf( "rm/all shared: %s\n",
+          cmd->conf == como_cmd_subcmd( cmd, "all" )->conf ? "yes" : "no" );
+
+  como_end();
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file como_speccache.c
+ *
+ * Test spec cache (save and load).
+ */
+
+#include <plinth.h>
+#include "../src/como.h"
+
+#define SPEC_FILE "como_speccache.spec"
+#define BAD_FILE "como_speccache.bad"
+#define SPEC_KEY "1.0"
+
+
+/**
+ * Display given options.
+ */
+void display_options( como_cmd_t cmd )
+{
+  como_opt_p opts;
+  como_cmd_t subcmd;
+
+  printf( "Options for: %s\n", cmd->longname );
+  for ( opts = cmd->opts; *opts; opts++ )
+    if ( ( *opts )->given )
+      {
+        printf( "  %s", ( *opts )->name );
+        if ( ( *opts )->value )
+          {
+            printf( ": " );
+            como_display_values( stdout, *opts );
+          }
+        printf( "\n" );
+      }
+
+  subcmd = como_cmd_given_subcmd( cmd );
+  if ( subcmd )
+    display_options( subcmd );
+}
+
+
+/**
+ * Specify commands (spec arrays are local to this function).
+ */
+void specify_commands( void )
+{
+  como_subcmd( "como_speccache", NULL,
+               { COMO_SWITCH, "verbose", "-v", "Verbose." },
+               { COMO_SUBCMD, "add",     NULL, "Add file." },
+               { COMO_SUBCMD, "rm",      NULL, "Remove file." }
+               );
+
+  como_subcmd( "add", "como_speccache",
+               { COMO_SWITCH, "force", "-f", "Force operation." },
+               { COMO_MULTI,  "file",  NULL, "Files." }
+               );
+  como_conf_autohelp( pl_false );
+
+  como_subcmd( "rm", "como_speccache",
+               { COMO_SINGLE, "file", "-f", "File." }
+               );
+}
+
+
+/**
+ * Write copy of spec file, truncated to size, with (up to 8) bytes
+ * from pos set to fill. Negative pos is from the end.
+ */
+void write_bad( long size, long pos, int fill )
+{
+  static char buf[ 64 * 1024 ];
+  FILE*       fh;
+  long        len;
+
+  fh = fopen( SPEC_FILE, "rb" );
+  len = fread( buf, 1, sizeof( buf ), fh );
+  fclose( fh );
+
+  if ( size > len )
+    size = len;
+  if ( pos < 0 )
+    pos = size + pos;
+  for ( long i = pos; i < size && i < pos + 8; i++ )
+    buf[ i ] = fill;
+
+  fh = fopen( BAD_FILE, "wb" );
+  fwrite( buf, 1, size, fh );
+  fclose( fh );
+}
+
+
+/**
+ * Try to load (stale or corrupt) spec file.
+ */
+void try_load( const char* label, const char* file, const char* key, char** argv )
+{
+  int ret;
+
+  como_init( 1, argv, "Como Tester", "2013" );
+  ret = como_spec_load( file, key );
+  printf( "%s: %d\n", label, ret );
+  if ( ret != 0 )
+    specify_commands();
+  como_end();
+}
+
+
+int main( int argc, char** argv )
+{
+  remove( SPEC_FILE );
+
+  /* First run: specify and save. */
+  como_init( argc, argv, "Como Tester", "2013" );
+  printf( "Load: %d\n", como_spec_load( SPEC_FILE, SPEC_KEY ) );
+  specify_commands();
+
+  printf( "Save: %d\n", como_spec_save( SPEC_FILE, SPEC_KEY ) );
+  como_end();
+
+  /* Stale and corrupt files are not loaded. */
+  try_load( "Stale", SPEC_FILE, "2.0", argv );
+  try_load( "No key", SPEC_FILE, NULL, argv );
+  write_bad( 100, 0, 0 );
+  try_load( "Truncated", BAD_FILE, SPEC_KEY, argv );
+  write_bad( 1 << 30, -1, 'x' );
+  try_load( "Unterminated string", BAD_FILE, SPEC_KEY, argv );
+  /* First command name offset. */
+  write_bad( 1 << 30, 80, 0x7f );
+  try_load( "Bad string", BAD_FILE, SPEC_KEY, argv );
+  write_bad( 1 << 30, 0, 'x' );
+  try_load( "Bad magic", BAD_FILE, SPEC_KEY, argv );
+  remove( BAD_FILE );
+
+  /* Second run: load. */
+  como_init( argc, argv, "Como Tester", "2013" );
+  printf( "Load: %d\n", como_spec_load( SPEC_FILE, SPEC_KEY ) );
+  como_finish();
+
+  display_options( como_main );
+
+  como_end();
+  remove( SPEC_FILE );
+
+  return 0;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file como_struct.c
+ *
+ * Test result struct generated from option list.
+ */
+
+#include <plinth.h>
+#include "../src/como.h"
+
+
+#define TEST_OPTS( X )                                                  \
+  X( COMO_OPT_SINGLE, int64_t,     threads, "-t", "Threads." )          \
+  X( COMO_OPT_SINGLE, int,         level,   "-l", "Level." )            \
+  X( COMO_OPT_SINGLE, double,      ratio,   "-r", "Ratio." )            \
+  X( COMO_OPT_SINGLE, const char*, file,    "-f", "File." )             \
+  X( COMO_OPT_MULTI,  char**,      tags,    "-g", "Tags." )             \
+  X( COMO_SWITCH,     _Bool,       debug,   "-d", "Debug." )            \
+  X( COMO_SWITCH,     int,         verbose, "-v", "Verbose." )          \
+  X( COMO_DEFAULT,    char**,      args,    NULL, "Arguments." )
+
+COMO_STRUCT( test_opts, TEST_OPTS )
+
+
+int main( int argc, char** argv )
+{
+  test_opts_s opts = { .threads = 1, .ratio = 0.5, .file = "<none>" };
+  char**      value;
+
+  como_init( argc, argv, "Como Tester", "2013" );
+  como_subcmd_table( "como_struct", NULL, test_opts_spec );
+  test_opts_bind( &opts );
+  como_finish();
+
+  printf( "threads: %ld\n", (long)opts.threads );
+  printf( "level: %d\n", opts.level );
+  printf( "ratio: %g\n", opts.ratio );
+  printf( "file: %s\n", opts.file );
+  printf( "debug: %s\n", opts.debug ? "true" : "false" );
+  printf( "verbose: %d\n", opts.verbose );
+
+  printf( "tags:" );
+  for ( value = opts.tags; value && *value; value++ )
+    printf( " %s", *value );
+  printf( "\n" );
+
+  printf( "args:" );
+  for ( value = opts.args; value && *value; value++ )
+    printf( " %s", *value );
+  printf( "\n" );
+
+  /* Handles generated from option list. */
+  printf( "handles: %ld %ld %ld\n",
+          (long)COMO_HANDLE( test_opts, threads ),
+          (long)COMO_HANDLE( test_opts, debug ),
+          (long)COMO_HANDLE( test_opts, args ) );
+  printf( "debug (by handle): %s\n",
+          como_given_at( COMO_HANDLE( test_opts, debug ) ) ? "given" : "not given" );
+
+  como_end();
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file como_valid.c
+ *
+ * Test option value validators, with serial and parallel (threads)
+ * validation. Command line is generated for the test case given as
+ * argument.
+ */
+
+#include <plinth.h>
+#include <regex.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/como.h"
+
+#define VALUE_CNT 5000
+
+
+/** Generated command line. */
+static char* args[ VALUE_CNT + 16 ];
+static int   argcnt = 0;
+
+
+/**
+ * Add argument to generated command line.
+ */
+void arg( const char* str )
+{
+  args[ argcnt++ ] = strdup( str );
+}
+
+
+/**
+ * Add many integer values, with invalid values at positions.
+ */
+void arg_values( int bad1, int bad2 )
+{
+  char buf[ 32 ];
+
+  for ( int i = 0; i < VALUE_CNT; i++ )
+    {
+      if ( i == bad1 || i == bad2 )
+        sprintf( buf, "x%d", i );
+      else
+        sprintf( buf, "%d", i );
+      arg( buf );
+    }
+}
+
+
+int main( int argc, char** argv )
+{
+  regex_t    re;
+  como_opt_t o;
+  como_cmd_t sub;
+  int        level = -1;
+
+  arg( "como_valid" );
+  if ( strcmp( argv[ 1 ], "many" ) == 0 )
+    {
+      arg( "-c" );
+      arg_values( -1, -1 );
+    }
+  else if ( strcmp( argv[ 1 ], "many_bad" ) == 0 )
+    {
+      arg( "-c" );
+      arg_values( 4321, 1234 );
+    }
+  else if ( strcmp( argv[ 1 ], "sub" ) == 0 )
+    {
+      arg( "sub" );
+      arg_values( -1, -1 );
+    }
+  else if ( strcmp( argv[ 1 ], "sub_bad" ) == 0 )
+    {
+      arg( "sub" );
+      arg_values( 4999, -1 );
+    }
+  else
+    {
+      /* Rest of the arguments as is. */
+      for ( int i = 2; i < argc; i++ )
+        arg( argv[ i ] );
+    }
+  args[ argcnt ] = NULL;
+
+  regcomp( &re, "^[a-z]+$", REG_EXTENDED | REG_NOSUB );
+
+  como_init( argcnt, args, "Como Tester", "2013" );
+  como_subcmd( "como_valid", NULL,
+               { COMO_OPT_MULTI,  "count", "-c", "Counts." },
+               { COMO_OPT_MULTI,  "file",  "-f", "Files." },
+               { COMO_OPT_SINGLE, "name",  "-n", "Name." },
+               { COMO_OPT_SINGLE, "level", "-l", "Level." },
+               { COMO_SUBCMD,     "sub",   NULL, "Subcommand." }
+               );
+  como_conf_threads( 4 );
+  como_conf_subcheck( pl_false );
+  como_conf_validator( "count", como_valid_integer, NULL );
+  como_conf_validator( "file", como_valid_path, NULL );
+  como_conf_validator( "name", como_valid_regex, &re );
+  como_bind( "level", COMO_BIND_INT, &level );
+
+  /* Configuration applies to the latest (sub)command. */
+  como_subcmd( "sub", "como_valid",
+               { COMO_DEFAULT, NULL, NULL, "Numbers." }
+               );
+  como_conf_validator( NULL, como_valid_integer, NULL );
+
+  como_finish();
+
+  o = como_given( "count" );
+  printf( "count: %ld values\n", o ? (long)o->valuecnt : 0L );
+  o = como_given( "file" );
+  printf( "file: %ld values\n", o ? (long)o->valuecnt : 0L );
+  o = como_given( "name" );
+  printf( "name: %s\n", o ? o->value[ 0 ] : "<none>" );
+  printf( "level: %d\n", level );
+  sub = como_given_subcmd();
+  if ( sub )
+    {
+      o = como_cmd_given( sub, NULL );
+      printf( "sub: %ld values\n", o ? (long)o->valuecnt : 0L );
+    }
+
+  como_end();
+  regfree( &re );
+
+  return 0;
+}
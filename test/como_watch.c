@@ -0,0 +1,127 @@
+/**
+ * @file como_watch.c
+ *
+ * Test hot reload: file arguments, snapshots, and change callback.
+ */
+
+#include <plinth.h>
+#include <unistd.h>
+#include "../src/como.h"
+
+#define ARGS_FILE "como_watch.args"
+
+
+/** Changes reported by callback. */
+static int changes = 0;
+
+
+/**
+ * Option change callback.
+ */
+void changed( como_cmd_t cmd, como_opt_t old, como_opt_t opt, void* arg )
+{
+  printf( "  changed \"%s\": %s -> %s\n",
+          opt ? opt->name : old->name,
+          ( old && old->given && old->valuecnt ) ? old->value[ 0 ] : "<none>",
+          ( opt && opt->given && opt->valuecnt ) ? opt->value[ 0 ] : "<none>" );
+  __atomic_add_fetch( &changes, 1, __ATOMIC_SEQ_CST );
+}
+
+
+/**
+ * Write arguments file (replaced as editors do).
+ */
+void write_args( const char* args )
+{
+  FILE* fh;
+
+  fh = fopen( ARGS_FILE ".tmp", "w" );
+  fputs( args, fh );
+  fclose( fh );
+  rename( ARGS_FILE ".tmp", ARGS_FILE );
+}
+
+
+/**
+ * Display snapshot values.
+ */
+void display_snap( void )
+{
+  como_snap_t snap;
+  como_opt_t  o;
+
+  snap = como_snap_get();
+  o = como_cmd_given( snap->cmd, "level" );
+  printf( "Snapshot: level=%s verbose=%s\n",
+          o ? o->value[ 0 ] : "<none>",
+          como_cmd_given( snap->cmd, "verbose" ) ? "true" : "false" );
+  como_snap_put( snap );
+}
+
+
+/**
+ * Display program's own results (not changed by reloads).
+ */
+void display_main( void )
+{
+  como_opt_t o;
+
+  o = como_given( "level" );
+  printf( "Command line: level=%s verbose=%s\n",
+          o ? o->value[ 0 ] : "<none>",
+          como_given( "verbose" ) ? "true" : "false" );
+}
+
+
+/**
+ * Wait for number of changes.
+ */
+void wait_changes( int cnt )
+{
+  for ( int i = 0; i < 500 && __atomic_load_n( &changes, __ATOMIC_SEQ_CST ) < cnt; i++ )
+    usleep( 10000 );
+}
+
+
+int main( int argc, char** argv )
+{
+  setvbuf( stdout, NULL, _IONBF, 0 );
+  write_args( "-l 1\n" );
+
+  como_command( "como_watch", "Como Tester", "2013",
+                { COMO_OPT_SINGLE, "level",   "-l", "Level." },
+                { COMO_SWITCH,     "verbose", "-v", "Verbose." }
+                );
+
+  display_main();
+  printf( "Watch: %d\n", como_watch( ARGS_FILE, changed, NULL ) );
+  display_snap();
+  display_main();
+  printf( "Second watch: %d\n", como_watch( ARGS_FILE, changed, NULL ) );
+
+  changes = 0;
+  write_args( "-l 2 # comment\n" );
+  wait_changes( 1 );
+  display_snap();
+
+  /* Invalid arguments are reported, and they are not published. */
+  changes = 0;
+  write_args( "-l\n" );
+  usleep( 300000 );
+  display_snap();
+  write_args( "-l 3\n" );
+  wait_changes( 1 );
+  display_snap();
+
+  changes = 0;
+  write_args( "" );
+  wait_changes( 1 );
+  display_snap();
+
+  display_main();
+  como_watch_stop();
+  como_end();
+  remove( ARGS_FILE );
+
+  return 0;
+}
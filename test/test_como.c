@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <unistd.h>
 #include <plinth.h>
 
 char buf_command[ 1024 ];
@@ -33,12 +34,35 @@ int run_test( char* test_name )
     plcm_use( &result, buf_result, 1024 );
     plcm_use( &golden, buf_golden, 1024 );
 
-    /* Compile test program. */
-    plss_reformat_string( &command,
-                          "gcc -Wall -g test/como_%s.c src/como.c -lplinth -o test/como_%s",
-                          test_name,
-                          test_name );
+    /* Compile test program (C++ tests link against como compiled as C). */
+    plss_reformat_string( &command, "test/como_%s.cc", test_name );
+    if ( access( plss_string( &command ), F_OK ) == 0 ) {
+        plss_reformat_string( &command,
+                              "gcc -Wall -g -c src/como.c -o test/como_%s.o && "
+                              "g++ -std=c++20 -Wall -g -rdynamic test/como_%s.cc test/como_%s.o "
+                              "-lplinth -lpthread -ldl -o test/como_%s",
+                              test_name,
+                              test_name,
+                              test_name,
+                              test_name );
+    } else {
+        plss_reformat_string( &command,
+                              "gcc -Wall -g -rdynamic test/como_%s.c src/como.c -lplinth -lpthread -ldl -o test/como_%s",
+                              test_name,
+                              test_name );
+    }
     system( plss_string( &command ) );
+
+    /* Compile plugin of test program, which uses como from the
+       program (hence -rdynamic above). */
+    plss_reformat_string( &command, "test/como_%s_so.c", test_name );
+    if ( access( plss_string( &command ), F_OK ) == 0 ) {
+        plss_reformat_string( &command,
+                              "gcc -Wall -g -shared -fPIC test/como_%s_so.c -o test/como_%s.so",
+                              test_name,
+                              test_name );
+        system( plss_string( &command ) );
+    }
     system( "mkdir -p test/result" );
 
     /* Prepare test result file. */
@@ -112,3 +136,117 @@ void test_type_prim( void )
 {
     run_test( "type_prim" );
 }
+
+
+void test_check( void )
+{
+    run_test( "check" );
+}
+
+
+void test_rules( void )
+{
+    run_test( "rules" );
+}
+
+
+void test_struct( void )
+{
+    run_test( "struct" );
+}
+
+
+void test_mem( void )
+{
+    run_test( "mem" );
+}
+
+
+void test_map( void )
+{
+    run_test( "map" );
+}
+
+
+void test_reparse( void )
+{
+    run_test( "reparse" );
+}
+
+
+void test_freeze( void )
+{
+    run_test( "freeze" );
+}
+
+
+void test_speccache( void )
+{
+    run_test( "speccache" );
+}
+
+
+void test_plugin( void )
+{
+    run_test( "plugin" );
+}
+
+
+void test_occur( void )
+{
+    run_test( "occur" );
+}
+
+
+void test_serve( void )
+{
+    run_test( "serve" );
+}
+
+
+void test_import( void )
+{
+    run_test( "import" );
+}
+
+
+void test_handle( void )
+{
+    run_test( "handle" );
+}
+
+
+void test_batch( void )
+{
+    run_test( "batch" );
+}
+
+
+void test_watch( void )
+{
+    run_test( "watch" );
+}
+
+
+void test_valid( void )
+{
+    run_test( "valid" );
+}
+
+
+void test_cpp( void )
+{
+    run_test( "cpp" );
+}
+
+
+void test_share( void )
+{
+    run_test( "share" );
+}
+
+
+void test_optmem( void )
+{
+    run_test( "optmem" );
+}